@@ -20,6 +20,11 @@ namespace Bembel {
  * It invokes a SuperSpace and uses the Glue and Projector class to
  *assemble a transformation matrix, which relates the SuperSpace to the desired
  *basis.
+ *
+ * Copies of an AnsatzSpace are cheap handles, which share the mesh and the
+ * transformation matrix. Both are immutable after init_AnsatzSpace, such that
+ * discrete operators, linear forms and potentials may keep their own copy.
+ * Use clone() for a copy which owns its transformation matrix.
  */
 template <typename Derived>
 class AnsatzSpace {
@@ -31,24 +36,31 @@ class AnsatzSpace {
   /**
    * \brief Default constructor
    */
-  AnsatzSpace() {}
+  AnsatzSpace()
+      : transformation_matrix_(
+            std::make_shared<const Eigen::SparseMatrix<double>>()),
+        structured_transformation_(
+            std::make_shared<const StructuredTransformation>()) {}
   /**
-   * \brief Copy constructor
+   * \brief Copy constructor, the copy shares the mesh and the transformation
+   * matrix with other.
    * \param other The object to copy from
    */
   AnsatzSpace(const AnsatzSpace &other) {
     super_space_ = other.super_space_;
     knot_repetition_ = other.knot_repetition_;
     transformation_matrix_ = other.transformation_matrix_;
+    structured_transformation_ = other.structured_transformation_;
   }
   /**
    * @brief Move constructor
    * @param other The object to move from
    */
   AnsatzSpace(AnsatzSpace &&other) {
-    super_space_ = other.super_space_;
+    super_space_ = std::move(other.super_space_);
     knot_repetition_ = other.knot_repetition_;
-    transformation_matrix_ = other.transformation_matrix_;
+    transformation_matrix_ = std::move(other.transformation_matrix_);
+    structured_transformation_ = std::move(other.structured_transformation_);
   }
   /**
    * \brief Copy assignment operator.
@@ -60,9 +72,10 @@ class AnsatzSpace {
    * \return A reference to the updated AnsatzSpace object.
    */
   AnsatzSpace &operator=(AnsatzSpace other) {
-    super_space_ = other.super_space_;
+    super_space_ = std::move(other.super_space_);
     knot_repetition_ = other.knot_repetition_;
-    transformation_matrix_ = other.transformation_matrix_;
+    transformation_matrix_ = std::move(other.transformation_matrix_);
+    structured_transformation_ = std::move(other.structured_transformation_);
     return *this;
   }
   /**
@@ -76,11 +89,14 @@ class AnsatzSpace {
    * \param polynomial_degree The degree of polynomials used in the space.
    * \param knot_repetition (optional) The number of repetitions of knots in the
    * space.
+   * \param bezier_elements (optional) If true, the geometry is evaluated by
+   * means of BezierElements, see ClusterTree::init_BezierElements.
    */
   AnsatzSpace(const Geometry &geometry, int refinement_level,
-              int polynomial_degree, int knot_repetition = 1) {
+              int polynomial_degree, int knot_repetition = 1,
+              bool bezier_elements = false) {
     init_AnsatzSpace(geometry, refinement_level, polynomial_degree,
-                     knot_repetition);
+                     knot_repetition, bezier_elements);
     return;
   }
   //////////////////////////////////////////////////////////////////////////////
@@ -98,17 +114,40 @@ class AnsatzSpace {
    * \param refinement_level The refinement level of the space.
    * \param polynomial_degree The degree of polynomials used in the space.
    * \param knot_repetition The number of repetitions of knots in the space.
+   * \param bezier_elements (optional) If true, the geometry is evaluated by
+   * means of BezierElements, see ClusterTree::init_BezierElements.
    */
   void init_AnsatzSpace(const Geometry &geometry, int refinement_level,
-                        int polynomial_degree, int knot_repetition) {
+                        int polynomial_degree, int knot_repetition,
+                        bool bezier_elements = false) {
     knot_repetition_ = knot_repetition;
-    super_space_.init_SuperSpace(geometry, refinement_level, polynomial_degree);
+    super_space_.init_SuperSpace(geometry, refinement_level, polynomial_degree,
+                                 bezier_elements);
     Projector<Derived> proj(super_space_, knot_repetition_);
     Glue<Derived> glue(super_space_, proj);
     transformation_matrix_ =
-        proj.get_projection_matrix() * glue.get_glue_matrix();
+        std::make_shared<const Eigen::SparseMatrix<double>>(
+            proj.get_projection_matrix() * glue.get_glue_matrix());
+    structured_transformation_ =
+        std::make_shared<const StructuredTransformation>(
+            super_space_, knot_repetition_, glue.get_glue_matrix());
     return;
   }
+  /**
+   * \brief Returns a copy of the AnsatzSpace which owns its transformation
+   * matrix, in contrast to the copy constructor.
+   *
+   * The mesh is still shared, since the ElementTree cannot be copied.
+   *
+   * \return The cloned AnsatzSpace.
+   */
+  AnsatzSpace clone() const {
+    AnsatzSpace other(*this);
+    other.transformation_matrix_ =
+        std::make_shared<const Eigen::SparseMatrix<double>>(
+            *transformation_matrix_);
+    return other;
+  }
   //////////////////////////////////////////////////////////////////////////////
   //    getters
   //////////////////////////////////////////////////////////////////////////////
@@ -169,7 +208,7 @@ class AnsatzSpace {
    *
    * \return The number of degrees of freedom.
    */
-  int get_number_of_dofs() const { return transformation_matrix_.cols(); }
+  int get_number_of_dofs() const { return transformation_matrix_->cols(); }
 
   /**
    * \brief Retrieves the geometry associated with this AnsatzSpace.
@@ -187,13 +226,43 @@ class AnsatzSpace {
    * \return A const reference to the transformation matrix.
    */
   const Eigen::SparseMatrix<double> &get_transformation_matrix() const {
+    return *transformation_matrix_;
+  }
+  /**
+   * \brief Retrieves the transformation matrix as a shared pointer, such that
+   * it may be kept without copying it.
+   *
+   * \return A shared pointer to the transformation matrix.
+   */
+  std::shared_ptr<const Eigen::SparseMatrix<double>>
+  get_shared_transformation_matrix() const {
     return transformation_matrix_;
   }
+  /**
+   * \brief Retrieves the structured representation of the transformation
+   * matrix, which applies the univariate projections on each patch.
+   *
+   * \return A const reference to the StructuredTransformation.
+   */
+  const StructuredTransformation &get_structured_transformation() const {
+    return *structured_transformation_;
+  }
+  /**
+   * \brief Retrieves the structured representation of the transformation
+   * matrix as a shared pointer.
+   *
+   * \return A shared pointer to the StructuredTransformation.
+   */
+  std::shared_ptr<const StructuredTransformation>
+  get_shared_structured_transformation() const {
+    return structured_transformation_;
+  }
   //////////////////////////////////////////////////////////////////////////////
   //    private member variables
   //////////////////////////////////////////////////////////////////////////////
  private:
-  Eigen::SparseMatrix<double> transformation_matrix_;
+  std::shared_ptr<const Eigen::SparseMatrix<double>> transformation_matrix_;
+  std::shared_ptr<const StructuredTransformation> structured_transformation_;
   SuperSpace<Derived> super_space_;
   int knot_repetition_;
 };
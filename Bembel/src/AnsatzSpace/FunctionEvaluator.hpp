@@ -23,12 +23,13 @@ class FunctionEvaluator {
   //////////////////////////////////////////////////////////////////////////////
   //    constructors
   //////////////////////////////////////////////////////////////////////////////
-  FunctionEvaluator() {}
+  FunctionEvaluator() : is_local_(false) {}
   FunctionEvaluator(const FunctionEvaluator &other) = default;
   FunctionEvaluator(FunctionEvaluator &&other) = default;
   FunctionEvaluator &operator=(FunctionEvaluator other) {
     ansatz_space_ = other.ansatz_space_;
     fun_ = other.fun_;
+    is_local_ = other.is_local_;
     polynomial_degree_plus_one_squared_ =
         other.polynomial_degree_plus_one_squared_;
     return *this;
@@ -49,6 +50,7 @@ class FunctionEvaluator {
   //////////////////////////////////////////////////////////////////////////////
   void init_FunctionEvaluator(const AnsatzSpace<Derived> &ansatz_space) {
     ansatz_space_ = ansatz_space;
+    is_local_ = false;
     auto polynomial_degree = ansatz_space_.get_polynomial_degree();
     polynomial_degree_plus_one_squared_ =
         (polynomial_degree + 1) * (polynomial_degree + 1);
@@ -110,8 +112,9 @@ class FunctionEvaluator {
     return eval_.eval(
         ansatz_space_.get_superspace(), polynomial_degree_plus_one_squared_,
         element, p,
-        fun_.block(polynomial_degree_plus_one_squared_ * element.id_, 0,
-                   polynomial_degree_plus_one_squared_,
+        fun_.block(is_local_ ? 0
+                             : polynomial_degree_plus_one_squared_ * element.id_,
+                   0, polynomial_degree_plus_one_squared_,
                    getFunctionSpaceVectorDimension<
                        LinearOperatorTraits<Derived>::Form>()));
   }
@@ -120,8 +123,9 @@ class FunctionEvaluator {
     return eval_.evalDiv(
         ansatz_space_.get_superspace(), polynomial_degree_plus_one_squared_,
         element, p,
-        fun_.block(polynomial_degree_plus_one_squared_ * element.id_, 0,
-                   polynomial_degree_plus_one_squared_,
+        fun_.block(is_local_ ? 0
+                             : polynomial_degree_plus_one_squared_ * element.id_,
+                   0, polynomial_degree_plus_one_squared_,
                    getFunctionSpaceVectorDimension<
                        LinearOperatorTraits<Derived>::Form>()));
   }
@@ -139,6 +143,23 @@ class FunctionEvaluator {
         Eigen::Map<Eigen::Matrix<typename LinearOperatorTraits<Derived>::Scalar,
                                  Eigen::Dynamic, vec_dim>>(
             longfun.data(), longfun.rows() / vec_dim, vec_dim);
+    is_local_ = false;
+  }
+  /**
+   * \brief Sets the function by its coefficients with respect to the shape
+   * functions of a single element. The function is then evaluated with these
+   * coefficients on every element, which allows to evaluate the local basis
+   * functions without storing coefficients for the whole SuperSpace.
+   */
+  void set_local_function(
+      const Eigen::Matrix<typename LinearOperatorTraits<Derived>::Scalar,
+                          Eigen::Dynamic,
+                          getFunctionSpaceVectorDimension<
+                              LinearOperatorTraits<Derived>::Form>()> &fun) {
+    assert(fun.rows() == polynomial_degree_plus_one_squared_ &&
+           "local function must have a coefficient per shape function");
+    fun_ = fun;
+    is_local_ = true;
   }
   //////////////////////////////////////////////////////////////////////////////
   //    private member variables
@@ -150,6 +171,7 @@ class FunctionEvaluator {
       typename LinearOperatorTraits<Derived>::Scalar, Eigen::Dynamic,
       getFunctionSpaceVectorDimension<LinearOperatorTraits<Derived>::Form>()>
       fun_;
+  bool is_local_;
   int polynomial_degree_plus_one_squared_;
   FunctionEvaluatorEval<typename LinearOperatorTraits<Derived>::Scalar,
                         LinearOperatorTraits<Derived>::Form, Derived>
@@ -144,6 +144,115 @@ struct _proj_info {
   int num_dc_dof;
 };
 
+/**
+ * \brief Local projection of the B-splines of a uniform knot vector onto the
+ * Bernstein polynomials on the elements of the same refinement level.
+ *
+ * For every element e of the uniform refinement of [0,1], dofs[e] contains
+ * the indices of the B-splines with support on the element, and the
+ * corresponding column of coefficients[e] the coefficients of their
+ * restriction to the element with respect to the Bernstein basis.
+ */
+struct _local_projection_1d {
+  int dim;
+  std::vector<std::vector<int>> dofs;
+  std::vector<Eigen::MatrixXd> coefficients;
+};
+
+/**
+ * \brief Solves the univariate interpolation problems of the local projection
+ * for B-splines of order pp1 and Bernstein polynomials of order
+ * maximal_polynomial_degree on the 2^M elements of level M.
+ */
+inline _local_projection_1d makeLocalProjection1D(
+    const int pp1, const int maximal_polynomial_degree,
+    const int knotrepetition, const int M) {
+  const int n = (1 << M);
+  // n-1 is passed, since n = number_elements but n-1 = number of interior
+  // knots.
+  const std::vector<double> c_space_knot =
+      Spl::MakeUniformKnotVector(pp1, n - 1, knotrepetition);
+  const std::vector<double> mask =
+      Spl::MakeInterpolationMask(maximal_polynomial_degree);
+  const int masksize = mask.size();
+  assert(masksize == maximal_polynomial_degree &&
+         "projector.cpp: System needs to be square");
+
+  _local_projection_1d out;
+  out.dim = c_space_knot.size() - pp1;
+  out.dofs.resize(n);
+  out.coefficients.resize(n);
+
+  // Here, we suddenly use the degree for basisevaluation, i.e.,
+  // maximal_polynomial_degree-1. This is confusing, but correct and tested.
+  Eigen::MatrixXd system(masksize, maximal_polynomial_degree);
+  {
+    double vals[Constants::MaxP + 1];
+    for (int i = 0; i < masksize; ++i) {
+      Bembel::Basis::ShapeFunctionHandler::evalBasis(
+          maximal_polynomial_degree - 1, vals, mask[i]);
+      for (int j = 0; j < maximal_polynomial_degree; ++j)
+        system(i, j) = vals[j];
+    }
+  }
+  const Eigen::PartialPivLU<Eigen::MatrixXd> pplu(system);
+
+#pragma omp parallel for
+  for (int e = 0; e < n; ++e) {
+    const double pos = double(e) / n;
+    const double mid = pos + .5 / n;
+    // indices of all basis functions which have a support on the element
+    for (int dof = 0; dof < out.dim; ++dof)
+      if ((c_space_knot[dof] <= mid) && (c_space_knot[dof + pp1] >= mid))
+        out.dofs[e].push_back(dof);
+
+    std::vector<double> local_mask(masksize);
+    for (int i = 0; i < masksize; ++i) {
+      local_mask[i] = pos + (1.0 / n) * mask[i];
+      assert(local_mask[i] < 1 && local_mask[i] > 0);
+    }
+    out.coefficients[e].resize(maximal_polynomial_degree, out.dofs[e].size());
+    for (int k = 0; k < int(out.dofs[e].size()); ++k) {
+      // evaluate rhs for interpolation problem
+      std::vector<double> c_coefs(out.dim, 0.0);
+      c_coefs[out.dofs[e][k]] = 1.;
+      const std::vector<double> vals =
+          Spl::DeBoor(c_coefs, c_space_knot, local_mask);
+      out.coefficients[e].col(k) =
+          pplu.solve(Eigen::Map<const Eigen::VectorXd>(vals.data(), masksize));
+    }
+  }
+  return out;
+}
+
+/**
+ * \brief Returns the local projection of makeLocalProjection1D.
+ *
+ * The local projections only depend on the polynomial degrees, the knot
+ * repetition and the refinement level. They are computed on the first request
+ * and shared by all patches and all subsequent requests in the process.
+ */
+inline std::shared_ptr<const _local_projection_1d> getLocalProjection1D(
+    const int pp1, const int maximal_polynomial_degree,
+    const int knotrepetition, const int M) {
+  static std::mutex mutex;
+  static std::map<std::array<int, 4>,
+                  std::shared_ptr<const _local_projection_1d>>
+      cache;
+  const std::array<int, 4> key = {
+      {pp1, maximal_polynomial_degree, knotrepetition, M}};
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = cache.find(key);
+  if (it == cache.end())
+    it = cache
+             .insert(std::make_pair(
+                 key, std::make_shared<const _local_projection_1d>(
+                          makeLocalProjection1D(pp1, maximal_polynomial_degree,
+                                                knotrepetition, M))))
+             .first;
+  return it->second;
+}
+
 template <typename Derived>
 /**
  * \brief This function solves on each element the interpolation problem to
@@ -151,8 +260,9 @@ template <typename Derived>
  *
  * This function returns the entries of the matrix which transforms Bernstein
  * polynomials to tensor product B-splines defined by the polynomial degree in x
- * and y direction. The local interpolation mask is filled with the DeBoor
- * algorithm and the system is solved with the Eigen::FullPivLU decomposition.
+ * and y direction. Since the interpolation problem is of tensor product form,
+ * it is solved in each direction by getLocalProjection1D. The resulting local
+ * projections are the same on every patch.
  *
  * \param super_space Reference to the SuperSpace handling basis functions.
  * \param pp1x Polynomial degree in x direction plus 1.
@@ -176,158 +286,86 @@ inline _proj_info makeLocalProjectionTriplets(
                                  : knotrepetition_in;
   const int n = (1 << M);
   const int patch_number = super_space.get_number_of_patches();
+  const int bernstein_dim =
+      maximal_polynomial_degree * maximal_polynomial_degree;
 
   // At the moment, we allow a difference of one only, i.e., we start our de
   // Rham sequence with a space of the same degree in every TP-direction.
   assert(std::abs(maximal_polynomial_degree - minp) <= 1);
 
   // Now, we construct the continuous spaces which will be the preimage of the
-  // projector. n-1 is passed, since n = number_elements but n-1 = number of
-  // interior knots.
-  std::vector<double> c_space_knot_x =
-      Spl::MakeUniformKnotVector(pp1x, n - 1, knotrepetition);
-  std::vector<double> c_space_knot_y =
-      Spl::MakeUniformKnotVector(pp1y, n - 1, knotrepetition);
-  const int c_space_dim_x = c_space_knot_x.size() - pp1x;
-  const int c_space_dim_y = c_space_knot_y.size() - pp1y;
+  // projector.
+  const std::shared_ptr<const _local_projection_1d> projection_x =
+      getLocalProjection1D(pp1x, maximal_polynomial_degree, knotrepetition, M);
+  const std::shared_ptr<const _local_projection_1d> projection_y =
+      getLocalProjection1D(pp1y, maximal_polynomial_degree, knotrepetition, M);
+  const int c_space_dim_x = projection_x->dim;
+  const int c_space_dim_y = projection_y->dim;
   const int c_space_dim = c_space_dim_x * c_space_dim_y;
 
-  _proj_info out;
-
-  out.cols.reserve(c_space_dim * maximal_polynomial_degree *
-                   maximal_polynomial_degree * patch_number);
-  out.vals.reserve(c_space_dim * maximal_polynomial_degree *
-                   maximal_polynomial_degree * patch_number);
-  out.rows.reserve(c_space_dim * maximal_polynomial_degree *
-                   maximal_polynomial_degree * patch_number);
-
-  std::vector<double> mask =
-      Spl::MakeInterpolationMask(maximal_polynomial_degree);
-  const int masksize = mask.size();
-
-  // Now we assemble our system which we use for the interpolation
-  assert(masksize == maximal_polynomial_degree &&
-         "projector.cpp: System needs to be square");
-  Eigen::Matrix<double, -1, -1> system(
-      masksize * masksize,
-      maximal_polynomial_degree * maximal_polynomial_degree);
-
-  // Here, we suddenly use the degree for basisevaluation, i.e.,
-  // maximal_polynomial_degree-1. This is confusing, but correct and tested.
-  {
-    double vals_y[Constants::MaxP + 1];
-    double vals_x[Constants::MaxP + 1];
-    for (int iy = 0; iy < maximal_polynomial_degree; ++iy) {
-      Bembel::Basis::ShapeFunctionHandler::evalBasis(
-          maximal_polynomial_degree - 1, vals_y, mask[iy]);
-      for (int ix = 0; ix < maximal_polynomial_degree; ++ix) {
-        Bembel::Basis::ShapeFunctionHandler::evalBasis(
-            maximal_polynomial_degree - 1, vals_x, mask[ix]);
-        for (int jy = 0; jy < maximal_polynomial_degree; ++jy) {
-          for (int jx = 0; jx < maximal_polynomial_degree; ++jx) {
-            system(iy * masksize + ix, jy * maximal_polynomial_degree + jx) =
-                vals_x[jx] * vals_y[jy];
-          }
-        }
-      }
-    }
-  }
-
-  // Do LU-Decomposition of
-  // systemsuper_space.get_mesh().get_element_tree().begin()
-  const Eigen::PartialPivLU<Eigen::Matrix<double, -1, -1>> pplu(system);
-
-  unsigned int element_number = 0;
-
+  std::vector<const ElementTreeNode*> elements;
   for (auto element = super_space.get_mesh().get_element_tree().cpbegin();
        element != super_space.get_mesh().get_element_tree().cpend();
-       ++element) {
-    // s = x
-    const double pos_x = element->llc_(0);
-    const double pos_y = element->llc_(1);
-
-    const double h = element->get_h();
-    const double mid_x = pos_x + (.5 * h);
-    const double mid_y = pos_y + (.5 * h);
-
-    // The following block of code computes the indeces of all continuous basis
-    // functions which have a support on the element of index 'element'
-    std::vector<double> nonzero_dofs_x;
-    std::vector<double> nonzero_dofs_y;
-    nonzero_dofs_x.reserve(pp1x);
-    nonzero_dofs_y.reserve(pp1y);
-    for (int dof_y = 0; dof_y < c_space_dim_y; ++dof_y) {
-      if ((c_space_knot_y[dof_y] <= mid_y) &&
-          (c_space_knot_y[dof_y + pp1y] >= mid_y)) {
-        nonzero_dofs_y.push_back(dof_y);
-      }
-    }
-    for (int dof_x = 0; dof_x < c_space_dim_x; ++dof_x) {
-      if ((c_space_knot_x[dof_x] <= mid_x) &&
-          (c_space_knot_x[dof_x + pp1x] >= mid_x)) {
-        nonzero_dofs_x.push_back(dof_x);
-      }
-    }
-    nonzero_dofs_x.shrink_to_fit();
-    nonzero_dofs_y.shrink_to_fit();
+       ++element)
+    elements.push_back(std::addressof(*element));
+  const int number_of_elements = elements.size();
+
+  // The entries of an element are the tensor products of the univariate
+  // local projections, where entries below the tolerance are dropped. They
+  // are counted first, such that all elements can be processed in parallel.
+  std::vector<int> offsets(number_of_elements + 1, 0);
+#pragma omp parallel for
+  for (int k = 0; k < number_of_elements; ++k) {
+    const int ix = std::lround(elements[k]->llc_(0) * n);
+    const int iy = std::lround(elements[k]->llc_(1) * n);
+    const Eigen::MatrixXd& coefs_x = projection_x->coefficients[ix];
+    const Eigen::MatrixXd& coefs_y = projection_y->coefficients[iy];
+    int count = 0;
+    for (int ky = 0; ky < coefs_y.cols(); ++ky)
+      for (int kx = 0; kx < coefs_x.cols(); ++kx)
+        for (int jy = 0; jy < maximal_polynomial_degree; ++jy)
+          for (int jx = 0; jx < maximal_polynomial_degree; ++jx)
+            if (std::abs(coefs_x(jx, kx) * coefs_y(jy, ky)) >
+                Constants::projector_tolerance)
+              ++count;
+    offsets[k + 1] = count;
+  }
+  for (int k = 0; k < number_of_elements; ++k) offsets[k + 1] += offsets[k];
 
+  _proj_info out;
+  out.cols.resize(offsets[number_of_elements]);
+  out.rows.resize(offsets[number_of_elements]);
+  out.vals.resize(offsets[number_of_elements]);
+#pragma omp parallel for
+  for (int k = 0; k < number_of_elements; ++k) {
+    const ElementTreeNode& element = *(elements[k]);
+    const int ix = std::lround(element.llc_(0) * n);
+    const int iy = std::lround(element.llc_(1) * n);
+    const Eigen::MatrixXd& coefs_x = projection_x->coefficients[ix];
+    const Eigen::MatrixXd& coefs_y = projection_y->coefficients[iy];
+    int pos = offsets[k];
     // We now loop over all basis functions wich are non-zero on the element
-    for (auto dof_y : nonzero_dofs_y) {
-      for (auto dof_x : nonzero_dofs_x) {
-        // The next few lines are to check if the element is within the support
-        // of the basis function given by dof_x and dof_y.
-        std::vector<double> local_mask_x(masksize);
-        std::vector<double> local_mask_y(masksize);
-        for (int i = 0; i < masksize; ++i) {
-          local_mask_x[i] = pos_x + (1.0 / n) * mask[i];
-          local_mask_y[i] = pos_y + (1.0 / n) * mask[i];
-          assert(local_mask_x[i] < 1 && local_mask_x[i] > 0);
-          assert(local_mask_y[i] < 1 && local_mask_y[i] > 0);
-        }
-
-        // build unit vectors
-        std::vector<double> c_coefs_x(c_space_dim_x, 0.0);
-        std::vector<double> c_coefs_y(c_space_dim_y, 0.0);
-        c_coefs_x[dof_x] = 1.;
-        c_coefs_y[dof_y] = 1.;
-
-        // evaluate rhs for interpolation problem
-        std::vector<double> vals_x =
-            Spl::DeBoor(c_coefs_x, c_space_knot_x, local_mask_x);
-        std::vector<double> vals_y =
-            Spl::DeBoor(c_coefs_y, c_space_knot_y, local_mask_y);
-
-        // assemble and solve interpolation problem
-        Eigen::VectorXd rhs(masksize * masksize);
-        for (int iy = 0; iy < masksize; ++iy)
-          for (int ix = 0; ix < masksize; ++ix)
-            rhs(iy * masksize + ix) = vals_x[ix] * vals_y[iy];
-        Eigen::VectorXd sol = pplu.solve(rhs);
-
-        // insert entries into helperstruct
-        for (int i = 0;
-             i < maximal_polynomial_degree * maximal_polynomial_degree; ++i) {
-          if (std::abs(sol(i)) > Constants::projector_tolerance) {
-            out.cols.push_back(element->patch_ * (c_space_dim) +
-                               (c_space_dim_x * dof_y) + dof_x);
-            out.rows.push_back((element_number * maximal_polynomial_degree *
-                                maximal_polynomial_degree) +
-                               i);
-            out.vals.push_back(sol(i));
+    for (int ky = 0; ky < coefs_y.cols(); ++ky)
+      for (int kx = 0; kx < coefs_x.cols(); ++kx) {
+        const int col = element.patch_ * c_space_dim +
+                        c_space_dim_x * projection_y->dofs[iy][ky] +
+                        projection_x->dofs[ix][kx];
+        for (int jy = 0; jy < maximal_polynomial_degree; ++jy)
+          for (int jx = 0; jx < maximal_polynomial_degree; ++jx) {
+            const double val = coefs_x(jx, kx) * coefs_y(jy, ky);
+            if (std::abs(val) > Constants::projector_tolerance) {
+              out.cols[pos] = col;
+              out.rows[pos] = k * bernstein_dim +
+                              jy * maximal_polynomial_degree + jx;
+              out.vals[pos] = val;
+              ++pos;
+            }
           }
-        }
       }
-    }
-    ++element_number;
   }
 
-  out.num_c_dof = c_space_dim_x * c_space_dim_y * patch_number;
-  out.num_dc_dof = maximal_polynomial_degree * maximal_polynomial_degree * n *
-                   n * patch_number;
-
-  out.cols.shrink_to_fit();
-  out.rows.shrink_to_fit();
-  out.vals.shrink_to_fit();
+  out.num_c_dof = c_space_dim * patch_number;
+  out.num_dc_dof = bernstein_dim * n * n * patch_number;
 
   assert((out.vals.size() == out.rows.size()) &&
          (out.rows.size() == out.cols.size()) &&
@@ -0,0 +1,313 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+#ifndef BEMBEL_SRC_ANSATZSPACE_STRUCTUREDTRANSFORMATION_HPP_
+#define BEMBEL_SRC_ANSATZSPACE_STRUCTUREDTRANSFORMATION_HPP_
+
+namespace Bembel {
+/**
+ * \ingroup AnsatzSpace
+ * \brief Structured representation of the transformation matrix of an
+ * AnsatzSpace.
+ *
+ * The transformation matrix is the product of the projection matrix and the
+ * glue matrix. On each patch and vector component, the projection matrix is
+ * the Kronecker product of two univariate projections, up to the ordering of
+ * the elements. Instead of the sparse matrix with (p+1)^2 entries per row,
+ * this class stores the univariate projections and applies them to the
+ * coefficients of each patch as a product of small matrices.
+ *
+ * The Projector drops entries below Constants::projector_tolerance, which is
+ * not possible in Kronecker form. The structured representation therefore
+ * only coincides with the transformation matrix if no product of the
+ * univariate coefficients falls below the tolerance, see is_exact().
+ */
+class StructuredTransformation {
+ public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// constructors
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Default constructor.
+   */
+  StructuredTransformation()
+      : number_of_patches_(0),
+        number_of_elements_per_direction_(0),
+        bernstein_order_(0),
+        rows_(0),
+        is_exact_(false) {}
+  /**
+   * \brief Constructor for the StructuredTransformation.
+   *
+   * \param super_space The SuperSpace to handle basis functions.
+   * \param knot_repetition The number of repetitions of knots in the space.
+   * \param glue_matrix The glue matrix of the AnsatzSpace.
+   */
+  template <typename Derived>
+  StructuredTransformation(const SuperSpace<Derived> &super_space,
+                           int knot_repetition,
+                           const Eigen::SparseMatrix<double> &glue_matrix) {
+    init_StructuredTransformation(super_space, knot_repetition, glue_matrix);
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// init
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Initializes the univariate projections in the same way as the
+   * Projector for the DifferentialForm of Derived.
+   *
+   * \param super_space The SuperSpace to handle basis functions.
+   * \param knot_repetition The number of repetitions of knots in the space.
+   * \param glue_matrix The glue matrix of the AnsatzSpace.
+   */
+  template <typename Derived>
+  void init_StructuredTransformation(
+      const SuperSpace<Derived> &super_space, int knot_repetition,
+      const Eigen::SparseMatrix<double> &glue_matrix) {
+    const int P = super_space.get_polynomial_degree();
+    number_of_patches_ = super_space.get_number_of_patches();
+    number_of_elements_per_direction_ = 1 << super_space.get_refinement_level();
+    bernstein_order_ = P + 1;
+    glue_matrix_ = glue_matrix;
+    components_.clear();
+    rows_ = 0;
+    if (static_cast<int>(LinearOperatorTraits<Derived>::Form) ==
+        DifferentialForm::DivConforming) {
+      addComponent(P + 1, P, knot_repetition,
+                   super_space.get_refinement_level());
+      addComponent(P, P + 1, knot_repetition,
+                   super_space.get_refinement_level());
+    } else {
+      addComponent(P + 1, P + 1, knot_repetition,
+                   super_space.get_refinement_level());
+    }
+    is_exact_ = true;
+    for (const auto &component : components_)
+      is_exact_ = is_exact_ && component.is_exact;
+
+    // element number of the element (ix,iy) on each patch, i.e., the block
+    // of rows of the projection matrix belonging to the element
+    const int n = number_of_elements_per_direction_;
+    element_numbers_.resize(number_of_patches_ * n * n);
+    int element_number = 0;
+    for (auto element = super_space.get_mesh().get_element_tree().cpbegin();
+         element != super_space.get_mesh().get_element_tree().cpend();
+         ++element) {
+      const int ix = std::lround(element->llc_(0) * n);
+      const int iy = std::lround(element->llc_(1) * n);
+      element_numbers_[(element->patch_ * n + iy) * n + ix] = element_number;
+      ++element_number;
+    }
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// methods
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Computes out = T * in, where T is the transformation matrix.
+   */
+  template <typename Scalar>
+  void apply(const Eigen::Matrix<Scalar, Eigen::Dynamic, 1> &in,
+             Eigen::Matrix<Scalar, Eigen::Dynamic, 1> *out) const {
+    const Eigen::Matrix<Scalar, Eigen::Dynamic, 1> glued = glue_matrix_ * in;
+    out->resize(rows_);
+    const int n = number_of_elements_per_direction_;
+    const int p = bernstein_order_;
+    const int number_of_blocks = components_.size() * number_of_patches_;
+#pragma omp parallel for
+    for (int block = 0; block < number_of_blocks; ++block) {
+      const Component &component = components_[block / number_of_patches_];
+      const int patch = block % number_of_patches_;
+      const Eigen::Map<const Eigen::Matrix<Scalar, Eigen::Dynamic,
+                                          Eigen::Dynamic>>
+          coefficients(glued.data() + component.col_offset +
+                           patch * component.dim_x * component.dim_y,
+                       component.dim_x, component.dim_y);
+      const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> local =
+          (component.factor_x * coefficients) *
+          component.factor_y.transpose();
+      for (int iy = 0; iy < n; ++iy)
+        for (int ix = 0; ix < n; ++ix) {
+          Scalar *dst = out->data() + component.row_offset +
+                        element_numbers_[(patch * n + iy) * n + ix] * p * p;
+          for (int jy = 0; jy < p; ++jy)
+            for (int jx = 0; jx < p; ++jx)
+              dst[jy * p + jx] = local(ix * p + jx, iy * p + jy);
+        }
+    }
+    return;
+  }
+  /**
+   * \brief Computes out = T^T * in, where T is the transformation matrix.
+   */
+  template <typename Scalar>
+  void applyTranspose(const Eigen::Matrix<Scalar, Eigen::Dynamic, 1> &in,
+                      Eigen::Matrix<Scalar, Eigen::Dynamic, 1> *out) const {
+    Eigen::Matrix<Scalar, Eigen::Dynamic, 1> projected(glue_matrix_.rows());
+    const int n = number_of_elements_per_direction_;
+    const int p = bernstein_order_;
+    const int number_of_blocks = components_.size() * number_of_patches_;
+#pragma omp parallel for
+    for (int block = 0; block < number_of_blocks; ++block) {
+      const Component &component = components_[block / number_of_patches_];
+      const int patch = block % number_of_patches_;
+      Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> local(n * p,
+                                                                  n * p);
+      for (int iy = 0; iy < n; ++iy)
+        for (int ix = 0; ix < n; ++ix) {
+          const Scalar *src = in.data() + component.row_offset +
+                              element_numbers_[(patch * n + iy) * n + ix] * p *
+                                  p;
+          for (int jy = 0; jy < p; ++jy)
+            for (int jx = 0; jx < p; ++jx)
+              local(ix * p + jx, iy * p + jy) = src[jy * p + jx];
+        }
+      Eigen::Map<Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>>(
+          projected.data() + component.col_offset +
+              patch * component.dim_x * component.dim_y,
+          component.dim_x, component.dim_y) =
+          (component.factor_x.transpose() * local) * component.factor_y;
+    }
+    *out = glue_matrix_.transpose() * projected;
+    return;
+  }
+  /**
+   * \brief Computes T^T * mat * T for a dense matrix mat with respect to the
+   * discontinuous shape functions.
+   */
+  template <typename Scalar>
+  void projectDense(
+      Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> *mat) const {
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> half(cols(),
+                                                               mat->cols());
+#pragma omp parallel for
+    for (int c = 0; c < mat->cols(); ++c) {
+      Eigen::Matrix<Scalar, Eigen::Dynamic, 1> col;
+      applyTranspose<Scalar>(mat->col(c), &col);
+      half.col(c) = col;
+    }
+    mat->resize(cols(), cols());
+#pragma omp parallel for
+    for (int r = 0; r < half.rows(); ++r) {
+      Eigen::Matrix<Scalar, Eigen::Dynamic, 1> row;
+      applyTranspose<Scalar>(half.row(r).transpose(), &row);
+      mat->row(r) = row.transpose();
+    }
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// getter
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Returns true if the structured representation coincides with the
+   * transformation matrix assembled by the Projector and the Glue.
+   */
+  bool is_exact() const { return is_exact_; }
+  /**
+   * \brief Returns true if the structured representation is exact and should
+   * be preferred over the sparse matrix. For polynomial degree one, the
+   * sparse matrix has only four entries per row and its products are faster.
+   */
+  bool is_preferable() const { return is_exact_ && bernstein_order_ > 2; }
+  int rows() const { return rows_; }
+  int cols() const { return glue_matrix_.cols(); }
+  //////////////////////////////////////////////////////////////////////////////
+  /// private members
+  //////////////////////////////////////////////////////////////////////////////
+ private:
+  /**
+   * \brief Univariate projections of a vector component.
+   */
+  struct Component {
+    Eigen::SparseMatrix<double> factor_x;
+    Eigen::SparseMatrix<double> factor_y;
+    int dim_x;
+    int dim_y;
+    int row_offset;
+    int col_offset;
+    bool is_exact;
+  };
+  /**
+   * \brief Adds a vector component with B-splines of order pp1x and pp1y,
+   * with the same conventions as makeLocalProjectionTriplets.
+   */
+  void addComponent(int pp1x, int pp1y, int knot_repetition_in, int M) {
+    const int maximal_polynomial_degree = std::max(pp1x, pp1y);
+    const int knotrepetition = (maximal_polynomial_degree <= knot_repetition_in)
+                                   ? std::min(pp1x, pp1y)
+                                   : knot_repetition_in;
+    const auto projection_x = ProjectorRoutines::getLocalProjection1D(
+        pp1x, maximal_polynomial_degree, knotrepetition, M);
+    const auto projection_y = ProjectorRoutines::getLocalProjection1D(
+        pp1y, maximal_polynomial_degree, knotrepetition, M);
+    Component component;
+    component.dim_x = projection_x->dim;
+    component.dim_y = projection_y->dim;
+    component.row_offset = rows_;
+    component.col_offset =
+        components_.empty()
+            ? 0
+            : components_.back().col_offset +
+                  number_of_patches_ * components_.back().dim_x *
+                      components_.back().dim_y;
+    double min_x = 1;
+    double min_y = 1;
+    component.factor_x =
+        makeFactor(*projection_x, maximal_polynomial_degree, &min_x);
+    component.factor_y =
+        makeFactor(*projection_y, maximal_polynomial_degree, &min_y);
+    // The coefficients are bounded by one, since the B-splines form a
+    // partition of unity. Thus, the Projector drops every product with a
+    // coefficient below the tolerance, and keeps all others if the smallest
+    // product is above the tolerance.
+    component.is_exact = min_x * min_y > Constants::projector_tolerance;
+    rows_ += number_of_patches_ * number_of_elements_per_direction_ *
+             number_of_elements_per_direction_ * maximal_polynomial_degree *
+             maximal_polynomial_degree;
+    components_.push_back(component);
+    return;
+  }
+  /**
+   * \brief Assembles the univariate projection as a sparse matrix mapping the
+   * B-spline coefficients to the Bernstein coefficients on all elements.
+   */
+  static Eigen::SparseMatrix<double> makeFactor(
+      const ProjectorRoutines::_local_projection_1d &projection,
+      int maximal_polynomial_degree, double *min_coefficient) {
+    const int n = projection.dofs.size();
+    std::vector<Eigen::Triplet<double>> trips;
+    for (int e = 0; e < n; ++e)
+      for (int k = 0; k < int(projection.dofs[e].size()); ++k)
+        for (int j = 0; j < maximal_polynomial_degree; ++j) {
+          const double val = projection.coefficients[e](j, k);
+          if (std::abs(val) > Constants::projector_tolerance) {
+            trips.push_back(Eigen::Triplet<double>(
+                e * maximal_polynomial_degree + j, projection.dofs[e][k], val));
+            *min_coefficient = std::min(*min_coefficient, std::abs(val));
+          }
+        }
+    Eigen::SparseMatrix<double> factor(n * maximal_polynomial_degree,
+                                       projection.dim);
+    factor.setFromTriplets(trips.begin(), trips.end());
+    return factor;
+  }
+
+  std::vector<Component> components_;
+  // element numbers of the elements (ix,iy) of each patch
+  std::vector<int> element_numbers_;
+  Eigen::SparseMatrix<double> glue_matrix_;
+  int number_of_patches_;
+  int number_of_elements_per_direction_;
+  int bernstein_order_;
+  int rows_;
+  bool is_exact_;
+};
+}  // namespace Bembel
+#endif  // BEMBEL_SRC_ANSATZSPACE_STRUCTUREDTRANSFORMATION_HPP_
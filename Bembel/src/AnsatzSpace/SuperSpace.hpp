@@ -15,8 +15,9 @@ namespace Bembel {
  * \ingroup AnsatzSpace
  * \brief The superspace manages local polynomial bases on each element of the
  * mesh and provides an interface to evaluate them.
- * 
- * 
+ *
+ * The mesh is shared by all copies of a SuperSpace, such that copies only
+ * hold a reference to the mesh and the pointers to the basis functions.
  */
 template <typename Derived>
 struct SuperSpace {
@@ -39,8 +40,12 @@ struct SuperSpace {
    * \param geom The geometry object defining the space.
    * \param M The refinement level of the space.
    * \param P The degree of polynomials used in the space.
+   * \param bezier_elements (optional) If true, the geometry is evaluated by
+   * means of BezierElements, see ClusterTree::init_BezierElements.
    */
-  SuperSpace(Geometry& geom, int M, int P) { init_SuperSpace(geom, M, P); }
+  SuperSpace(Geometry& geom, int M, int P, bool bezier_elements = false) {
+    init_SuperSpace(geom, M, P, bezier_elements);
+  }
   /**
    * \brief Copy constructor for the SuperSpace class.
    *
@@ -72,7 +77,7 @@ struct SuperSpace {
    * \param other The SuperSpace object to move from.
    */
   SuperSpace(SuperSpace&& other) {
-    mesh_ = other.mesh_;
+    mesh_ = std::move(other.mesh_);
     phi = other.phi;
     phiDx = other.phiDx;
     phiPhi = other.phiPhi;
@@ -95,7 +100,7 @@ struct SuperSpace {
    * \return A reference to the updated SuperSpace object.
    */
   SuperSpace& operator=(SuperSpace other) {
-    mesh_ = other.mesh_;
+    mesh_ = std::move(other.mesh_);
     phi = other.phi;
     phiDx = other.phiDx;
     phiPhi = other.phiPhi;
@@ -124,7 +129,8 @@ struct SuperSpace {
   //////////////////////////////////////////////////////////////////////////////
   //    init_SuperSpace
   //////////////////////////////////////////////////////////////////////////////
-  void init_SuperSpace(const Geometry& geom, int M, int P) {
+  void init_SuperSpace(const Geometry& geom, int M, int P,
+                       bool bezier_elements = false) {
     polynomial_degree = P;
     polynomial_degree_plus_one_squared =
         (polynomial_degree + 1) * (polynomial_degree + 1);
@@ -139,7 +145,7 @@ struct SuperSpace {
     divPhiTimesDivPhi =
         (Basis::BasisHandler<Scalar>::funPtrDivPhiTimesDivPhi(P));
     mesh_ = std::make_shared<ClusterTree>();
-    mesh_->init_ClusterTree(geom, M);
+    mesh_->init_ClusterTree(geom, M, bezier_elements);
     mesh_->checkOrientation();
     return;
   }
@@ -151,6 +157,8 @@ struct SuperSpace {
    *
    * This function performs the affine transformation of an element to the
    * reference domain of the patch and returns the output in a surface point.
+   * If the mesh provides BezierElements, these are used for the elements of
+   * the finest level instead.
    *
    * \param e       : Element to be evaluated,
    * \param xi      : Point in [0, 1]^2 of the element
@@ -159,6 +167,10 @@ struct SuperSpace {
    */
   void map2surface(const ElementTreeNode& e, const Eigen::Vector2d& xi,
                    double w, SurfacePoint* surf_pt) const {
+    if (mesh_->has_bezier_elements() && e.level_ == mesh_->get_max_level()) {
+      mesh_->get_bezier_element(e.id_).updateSurfacePoint(surf_pt, xi, w);
+      return;
+    }
     Eigen::Vector2d st = e.llc_ + e.get_h() * xi;
     mesh_->get_geometry()[e.patch_].updateSurfacePoint(surf_pt, st, w, xi);
     return;
@@ -65,8 +65,12 @@ class ClusterTree {
    *
    * \param geom The geometry object to construct a cluster tree on.
    * \param M refinement level of the ElementTree.
+   * \param bezier_elements (optional) If true, the BezierElements are
+   * initialized, see init_BezierElements.
    */
-  ClusterTree(const Geometry& geom, int M) { init_ClusterTree(geom, M); }
+  ClusterTree(const Geometry& geom, int M, bool bezier_elements = false) {
+    init_ClusterTree(geom, M, bezier_elements);
+  }
   //////////////////////////////////////////////////////////////////////////////
   /// init
   //////////////////////////////////////////////////////////////////////////////
@@ -78,10 +82,33 @@ class ClusterTree {
    *
    * \param geom The geometry object to construct a cluster tree on.
    * \param M refinement level of the ElementTree.
+   * \param bezier_elements (optional) If true, the BezierElements are
+   * initialized, see init_BezierElements.
    */
-  void init_ClusterTree(const Geometry& geom, int M) {
+  void init_ClusterTree(const Geometry& geom, int M,
+                        bool bezier_elements = false) {
     element_tree_.init_ElementTree(geom, M);
     points_ = element_tree_.computeElementEnclosings();
+    quadrature_cache_ = std::make_shared<QuadratureGeometryCache>();
+    bezier_elements_.reset();
+    if (bezier_elements) init_BezierElements();
+    return;
+  }
+  /**
+   * \brief Recomputes the data which depends on the elements after the
+   * ElementTree has been refined.
+   *
+   * The refinement may reallocate the nodes of the ElementTree, see
+   * ElementTree::refineLeafs. Therefore, the element enclosings are
+   * recomputed, the surface points of the QuadratureGeometryCache are
+   * released and the BezierElements are initialized again if they were
+   * present. Objects which point to the elements, e.g., an ElementBVH, have to
+   * be set up again.
+   */
+  void updateAfterRefinement() {
+    points_ = element_tree_.computeElementEnclosings();
+    quadrature_cache_->clear();
+    if (has_bezier_elements()) init_BezierElements();
     return;
   }
   //////////////////////////////////////////////////////////////////////////////
@@ -127,6 +154,76 @@ class ClusterTree {
   int get_number_of_elements() const {
     return element_tree_.get_number_of_elements();
   }
+  /**
+   * \brief Return the points of a cubature rule mapped to all elements.
+   *
+   * The surface points are computed on the first request of the rule and
+   * shared by all subsequent requests, see QuadratureGeometryCache. Copies of
+   * the ClusterTree share the cache.
+   *
+   * \param Q Cubature rule on the unit square.
+   * \return Surface points indexed by the element id.
+   */
+  template <typename Cubature>
+  std::shared_ptr<const std::vector<ElementSurfacePoints>>
+  get_quadrature_points(const Cubature &Q) const {
+    assert(quadrature_cache_ && "ClusterTree is not initialized");
+    return quadrature_cache_->get_surface_points(
+        element_tree_, bezier_elements_.get(), Q);
+  }
+  /**
+   * \brief Return the cache of the surface points of the cubature rules.
+   *
+   * \return Reference to the QuadratureGeometryCache.
+   */
+  QuadratureGeometryCache &get_quadrature_cache() const {
+    assert(quadrature_cache_ && "ClusterTree is not initialized");
+    return *quadrature_cache_;
+  }
+  /**
+   * \brief Extracts the rational Bezier representation of the geometry on
+   * all elements, such that SuperSpace::map2surface evaluates the geometry
+   * without the B-spline representation of the patches, see BezierElement.
+   *
+   * This has to be called before the mesh is used in assembly routines,
+   * usually by means of the corresponding flag of init_ClusterTree, since the
+   * mesh is shared by all copies of the SuperSpace. The surface points of
+   * the QuadratureGeometryCache are released, such that they are recomputed
+   * by means of the BezierElements on the next request.
+   */
+  void init_BezierElements() {
+    const PatchVector &geometry = element_tree_.get_geometry();
+    std::vector<const ElementTreeNode *> elements;
+    for (auto element = element_tree_.cpbegin();
+         element != element_tree_.cpend(); ++element)
+      elements.push_back(std::addressof(*element));
+    auto bezier_elements =
+        std::make_shared<std::vector<BezierElement>>(elements.size());
+#pragma omp parallel for
+    for (auto e = 0; e < elements.size(); ++e) {
+      const ElementTreeNode &element = *elements[e];
+      (*bezier_elements)[element.id_].init_BezierElement(
+          geometry[element.patch_], element.llc_, element.get_h());
+    }
+    bezier_elements_ = bezier_elements;
+    quadrature_cache_->clear();
+    return;
+  }
+  /**
+   * \brief Return true if init_BezierElements has been called.
+   */
+  bool has_bezier_elements() const { return bezier_elements_ != nullptr; }
+  /**
+   * \brief Return the rational Bezier representation of the geometry on the
+   * leaf element with the given id.
+   *
+   * \param id Id of the element.
+   * \return Const reference to the BezierElement.
+   */
+  const BezierElement &get_bezier_element(int id) const {
+    assert(bezier_elements_ && "init_BezierElements has not been called");
+    return (*bezier_elements_)[id];
+  }
   //////////////////////////////////////////////////////////////////////////////
   /// member functions
   //////////////////////////////////////////////////////////////////////////////
@@ -163,6 +260,8 @@ class ClusterTree {
  private:
   ElementTree element_tree_;
   Eigen::MatrixXd points_;
+  std::shared_ptr<QuadratureGeometryCache> quadrature_cache_;
+  std::shared_ptr<const std::vector<BezierElement>> bezier_elements_;
   //////////////////////////////////////////////////////////////////////////////
 };
 }  // namespace Bembel
@@ -0,0 +1,498 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+#ifndef BEMBEL_SRC_CLUSTERTREE_ELEMENTBVH_HPP_
+#define BEMBEL_SRC_CLUSTERTREE_ELEMENTBVH_HPP_
+
+namespace Bembel {
+/**
+ *  \ingroup ClusterTree
+ *  \brief A node of the ElementBVH.
+ */
+struct ElementBVHNode {
+  Eigen::Vector3d bbox_min_;     /// lower corner of the bounding box
+  Eigen::Vector3d bbox_max_;     /// upper corner of the bounding box
+  Eigen::Vector3d centroid_;     /// centroid of the surface
+  Eigen::Vector3d area_normal_;  /// integral of the normal over the surface
+  double area_;                  /// area of the surface
+  double radius_;  /// radius of the ball around the centroid enclosing the box
+  const ElementTreeNode *element_;  /// element, nullptr above the patches
+  std::vector<int> sons_;           /// indices of the sons
+};
+/**
+ *  \ingroup ClusterTree
+ *  \brief Bounding volume hierarchy over the elements of a ClusterTree for
+ *  spatial queries against the discretized surface.
+ *
+ *  Above the patches, the hierarchy bisects the patches at the median of
+ *  their centroids along the longest side of the bounding box, as the
+ *  PointClusterTree. Below the patches, it follows the ElementTree. The
+ *  hierarchy keeps its own BezierElements of the elements, such that the
+ *  geometry evaluation of the mesh is not affected. The bounding boxes of the
+ *  elements are the ones of the control nets of their BezierElements, which
+ *  contain the elements if the weights are positive.
+ *
+ *  Distances are computed by a projected Gauss-Newton method on the elements.
+ *  The inside test assumes a closed surface with outward normals. It uses the
+ *  winding number, where the contribution of a cluster far away from the point
+ *  is approximated by its dipole, and the normal at the closest point for
+ *  points closer to the surface than the size of the closest element.
+ */
+class ElementBVH {
+ public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// constructors
+  //////////////////////////////////////////////////////////////////////////////
+  ElementBVH() : root_(-1) {}
+  explicit ElementBVH(const ClusterTree &mesh) { init_ElementBVH(mesh); }
+  //////////////////////////////////////////////////////////////////////////////
+  /// init
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Sets up the hierarchy. The mesh needs to outlive the hierarchy.
+   * Since the hierarchy points to the elements, it has to be set up again
+   * after the mesh has been refined, see ElementTree::refineLeafs.
+   *
+   * \param mesh ClusterTree whose elements are organized.
+   */
+  void init_ElementBVH(const ClusterTree &mesh) {
+    const PatchVector &geometry = mesh.get_geometry();
+    const ElementTree &element_tree = mesh.get_element_tree();
+    std::vector<const ElementTreeNode *> elements;
+    for (auto element = element_tree.cpbegin();
+         element != element_tree.cpend(); ++element)
+      elements.push_back(std::addressof(*element));
+    bezier_elements_.clear();
+    bezier_elements_.resize(elements.size());
+#pragma omp parallel for
+    for (auto e = 0; e < elements.size(); ++e) {
+      const ElementTreeNode &element = *elements[e];
+      bezier_elements_[element.id_].init_BezierElement(
+          geometry[element.patch_], element.llc_, element.get_h());
+    }
+    // the bounding boxes and moments of the elements
+    std::vector<ElementBVHNode> leafs(elements.size());
+#pragma omp parallel for
+    for (auto e = 0; e < elements.size(); ++e)
+      computeElementNode(*elements[e], &(leafs[elements[e]->id_]));
+    // the subtrees of the patches are followed by the tree above them
+    nodes_.clear();
+    std::vector<int> patches;
+    for (const ElementTreeNode &patch : element_tree.root().sons_)
+      patches.push_back(appendElement(patch, leafs));
+    root_ = appendPatches(&patches, 0, patches.size());
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// methods
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Computes the distance of a point to the surface.
+   *
+   * \param point Point in space.
+   * \param element If not nullptr, the closest element is stored here.
+   * \param xi If not nullptr, the closest point in the reference domain of the
+   * closest element is stored here.
+   * \return Distance to the surface.
+   */
+  double computeDistance(const Eigen::Vector3d &point,
+                         const ElementTreeNode **element = nullptr,
+                         Eigen::Vector2d *xi = nullptr) const {
+    double distance = std::numeric_limits<double>::infinity();
+    Eigen::Vector2d closest_xi(.5, .5);
+    const ElementTreeNode *closest_element = nullptr;
+    std::vector<int> stack(1, root_);
+    while (stack.size()) {
+      const ElementBVHNode &node = nodes_[stack.back()];
+      stack.pop_back();
+      if (computeBoxDistance(node, point) >= distance) continue;
+      if (node.sons_.size()) {
+        pushSons(node, point, &stack);
+      } else {
+        Eigen::Vector2d t;
+        const double d = computeElementDistance(*node.element_, point, &t);
+        if (d < distance) {
+          distance = d;
+          closest_xi = t;
+          closest_element = node.element_;
+        }
+      }
+    }
+    if (element != nullptr) *element = closest_element;
+    if (xi != nullptr) *xi = closest_xi;
+    return distance;
+  }
+  /**
+   * \brief Returns true if the distance of a point to the surface is below the
+   * threshold.
+   */
+  bool isNearSurface(const Eigen::Vector3d &point, double threshold) const {
+    std::vector<int> stack(1, root_);
+    while (stack.size()) {
+      const ElementBVHNode &node = nodes_[stack.back()];
+      stack.pop_back();
+      if (computeBoxDistance(node, point) >= threshold) continue;
+      if (node.sons_.size()) {
+        pushSons(node, point, &stack);
+      } else {
+        Eigen::Vector2d t;
+        if (computeElementDistance(*node.element_, point, &t) < threshold)
+          return true;
+      }
+    }
+    return false;
+  }
+  /**
+   * \brief Computes the winding number of the surface with respect to a
+   * point, i.e., the solid angle of the surface seen from the point divided
+   * by 4 pi. The contributions of the elements close to the point are
+   * computed by a fixed quadrature rule, such that the accuracy deteriorates
+   * for points very close to the surface, see isInside.
+   */
+  double computeWindingNumber(const Eigen::Vector3d &point) const {
+    const Cubature &Q =
+        getGaussSquare<Constants::maximum_quadrature_degree>()[15];
+    double winding_number = 0;
+    std::vector<int> stack(1, root_);
+    while (stack.size()) {
+      const ElementBVHNode &node = nodes_[stack.back()];
+      stack.pop_back();
+      const Eigen::Vector3d d = node.centroid_ - point;
+      const double r = d.norm();
+      if (r > 4 * node.radius_) {
+        // dipole approximation of the far field
+        winding_number += node.area_normal_.dot(d) / (r * r * r);
+      } else if (node.sons_.size()) {
+        for (auto son : node.sons_) stack.push_back(son);
+      } else {
+        const BezierElement &bezier_element =
+            bezier_elements_[node.element_->id_];
+        const double h2 = node.element_->get_h() * node.element_->get_h();
+        SurfacePoint srf_pt;
+        for (auto k = 0; k < Q.w_.size(); ++k) {
+          bezier_element.updateSurfacePoint(&srf_pt, Q.xi_.col(k), Q.w_(k));
+          const Eigen::Vector3d y = srf_pt.segment<3>(3) - point;
+          const double ry = y.norm();
+          winding_number += Q.w_(k) * h2 *
+                            y.dot(srf_pt.segment<3>(6).cross(
+                                srf_pt.segment<3>(9))) /
+                            (ry * ry * ry);
+        }
+      }
+    }
+    return winding_number / (4. * BEMBEL_PI);
+  }
+  /**
+   * \brief Returns true if the point lies inside the closed surface.
+   */
+  bool isInside(const Eigen::Vector3d &point) const {
+    const ElementTreeNode *element;
+    Eigen::Vector2d xi;
+    const double distance = computeDistance(point, &element, &xi);
+    if (distance < element->radius_) {
+      // the quadrature of the winding number is not reliable close to the
+      // surface, but the normal at the closest point is
+      SurfacePoint srf_pt;
+      bezier_elements_[element->id_].updateSurfacePoint(&srf_pt, xi, 1.);
+      return (point - srf_pt.segment<3>(3))
+                 .dot(srf_pt.segment<3>(6).cross(srf_pt.segment<3>(9))) < 0;
+    }
+    return computeWindingNumber(point) > .5;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// batched methods
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Computes the closest elements and distances for a set of points in
+   * parallel, see computeDistance.
+   *
+   * \param points Points in space, one point per row.
+   * \param elements If not nullptr, the closest elements are stored here.
+   * \param xi If not nullptr, the closest points in the reference domains of
+   * the closest elements are stored here, one point per row.
+   * \return Distances to the surface.
+   */
+  Eigen::VectorXd computeDistances(
+      const Eigen::Matrix<double, Eigen::Dynamic, 3> &points,
+      std::vector<const ElementTreeNode *> *elements = nullptr,
+      Eigen::Matrix<double, Eigen::Dynamic, 2> *xi = nullptr) const {
+    Eigen::VectorXd distances(points.rows());
+    if (elements != nullptr) elements->resize(points.rows());
+    if (xi != nullptr) xi->resize(points.rows(), 2);
+#pragma omp parallel for schedule(dynamic)
+    for (auto i = 0; i < points.rows(); ++i) {
+      const ElementTreeNode *element;
+      Eigen::Vector2d t;
+      distances(i) =
+          computeDistance(Eigen::Vector3d(points.row(i)), &element, &t);
+      if (elements != nullptr) (*elements)[i] = element;
+      if (xi != nullptr) xi->row(i) = t.transpose();
+    }
+    return distances;
+  }
+  /**
+   * \brief Returns 1 for the points whose distance to the surface is below the
+   * threshold and 0 otherwise. The points are handled in parallel.
+   */
+  Eigen::VectorXi isNearSurface(
+      const Eigen::Matrix<double, Eigen::Dynamic, 3> &points,
+      double threshold) const {
+    Eigen::VectorXi retval(points.rows());
+#pragma omp parallel for schedule(dynamic)
+    for (auto i = 0; i < points.rows(); ++i)
+      retval(i) = isNearSurface(Eigen::Vector3d(points.row(i)), threshold);
+    return retval;
+  }
+  /**
+   * \brief Computes the winding numbers of a set of points in parallel.
+   */
+  Eigen::VectorXd computeWindingNumbers(
+      const Eigen::Matrix<double, Eigen::Dynamic, 3> &points) const {
+    Eigen::VectorXd retval(points.rows());
+#pragma omp parallel for schedule(dynamic)
+    for (auto i = 0; i < points.rows(); ++i)
+      retval(i) = computeWindingNumber(Eigen::Vector3d(points.row(i)));
+    return retval;
+  }
+  /**
+   * \brief Returns 1 for the points inside the closed surface and 0
+   * otherwise. The points are handled in parallel.
+   */
+  Eigen::VectorXi isInside(
+      const Eigen::Matrix<double, Eigen::Dynamic, 3> &points) const {
+    Eigen::VectorXi retval(points.rows());
+#pragma omp parallel for schedule(dynamic)
+    for (auto i = 0; i < points.rows(); ++i)
+      retval(i) = isInside(Eigen::Vector3d(points.row(i)));
+    return retval;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// getter
+  //////////////////////////////////////////////////////////////////////////////
+  const std::vector<ElementBVHNode> &get_nodes() const { return nodes_; }
+  int get_root() const { return root_; }
+  /**
+   * \brief Return the rational Bezier representation of the geometry on the
+   * leaf element with the given id.
+   */
+  const BezierElement &get_bezier_element(int id) const {
+    return bezier_elements_[id];
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// private members
+  //////////////////////////////////////////////////////////////////////////////
+ private:
+  /**
+   * \brief Computes the bounding box of the control net and the moments of an
+   * element.
+   */
+  void computeElementNode(const ElementTreeNode &element,
+                          ElementBVHNode *node) const {
+    const BezierElement &bezier_element = bezier_elements_[element.id_];
+    const std::vector<double> &net = bezier_element.get_data();
+    node->bbox_min_.setConstant(std::numeric_limits<double>::infinity());
+    node->bbox_max_.setConstant(-std::numeric_limits<double>::infinity());
+    for (auto k = 0; k < net.size(); k += 4) {
+      const Eigen::Vector3d p =
+          Eigen::Vector3d(net[k], net[k + 1], net[k + 2]) / net[k + 3];
+      node->bbox_min_ = node->bbox_min_.cwiseMin(p);
+      node->bbox_max_ = node->bbox_max_.cwiseMax(p);
+    }
+    const Cubature &Q =
+        getGaussSquare<Constants::maximum_quadrature_degree>()[7];
+    const double h2 = element.get_h() * element.get_h();
+    SurfacePoint srf_pt;
+    node->centroid_.setZero();
+    node->area_normal_.setZero();
+    node->area_ = 0;
+    for (auto k = 0; k < Q.w_.size(); ++k) {
+      bezier_element.updateSurfacePoint(&srf_pt, Q.xi_.col(k), Q.w_(k));
+      const Eigen::Vector3d n =
+          Q.w_(k) * h2 * srf_pt.segment<3>(6).cross(srf_pt.segment<3>(9));
+      node->area_normal_ += n;
+      node->area_ += n.norm();
+      node->centroid_ += n.norm() * srf_pt.segment<3>(3);
+    }
+    node->centroid_ /= node->area_;
+    node->radius_ = computeRadius(*node);
+    node->element_ = std::addressof(element);
+    return;
+  }
+  /**
+   * \brief Merges the bounding boxes and moments of the sons into the node.
+   */
+  void mergeSons(ElementBVHNode *node) const {
+    node->bbox_min_.setConstant(std::numeric_limits<double>::infinity());
+    node->bbox_max_.setConstant(-std::numeric_limits<double>::infinity());
+    node->centroid_.setZero();
+    node->area_normal_.setZero();
+    node->area_ = 0;
+    for (auto son : node->sons_) {
+      const ElementBVHNode &son_node = nodes_[son];
+      node->bbox_min_ = node->bbox_min_.cwiseMin(son_node.bbox_min_);
+      node->bbox_max_ = node->bbox_max_.cwiseMax(son_node.bbox_max_);
+      node->area_normal_ += son_node.area_normal_;
+      node->area_ += son_node.area_;
+      node->centroid_ += son_node.area_ * son_node.centroid_;
+    }
+    node->centroid_ /= node->area_;
+    node->radius_ = computeRadius(*node);
+    return;
+  }
+  /**
+   * \brief Appends the node of an element and recursively all its sons.
+   * Returns the index of the node.
+   */
+  int appendElement(const ElementTreeNode &element,
+                    const std::vector<ElementBVHNode> &leafs) {
+    if (!element.sons_.size()) {
+      nodes_.push_back(leafs[element.id_]);
+      return nodes_.size() - 1;
+    }
+    ElementBVHNode node;
+    for (const ElementTreeNode &son : element.sons_)
+      node.sons_.push_back(appendElement(son, leafs));
+    mergeSons(&node);
+    node.element_ = std::addressof(element);
+    nodes_.push_back(node);
+    return nodes_.size() - 1;
+  }
+  /**
+   * \brief Appends the tree above the patch nodes patches[begin], ...,
+   * patches[end - 1]. Returns the index of its root.
+   */
+  int appendPatches(std::vector<int> *patches, int begin, int end) {
+    if (end - begin == 1) return (*patches)[begin];
+    Eigen::Vector3d bbox_min, bbox_max;
+    bbox_min.setConstant(std::numeric_limits<double>::infinity());
+    bbox_max.setConstant(-std::numeric_limits<double>::infinity());
+    for (auto i = begin; i < end; ++i) {
+      bbox_min = bbox_min.cwiseMin(nodes_[(*patches)[i]].centroid_);
+      bbox_max = bbox_max.cwiseMax(nodes_[(*patches)[i]].centroid_);
+    }
+    // bisect along the longest side of the bounding box
+    int dir;
+    (bbox_max - bbox_min).maxCoeff(&dir);
+    const int mid = begin + (end - begin) / 2;
+    std::nth_element(patches->begin() + begin, patches->begin() + mid,
+                     patches->begin() + end, [this, dir](int a, int b) {
+                       return nodes_[a].centroid_(dir) <
+                              nodes_[b].centroid_(dir);
+                     });
+    ElementBVHNode node;
+    node.sons_.push_back(appendPatches(patches, begin, mid));
+    node.sons_.push_back(appendPatches(patches, mid, end));
+    mergeSons(&node);
+    node.element_ = nullptr;
+    nodes_.push_back(node);
+    return nodes_.size() - 1;
+  }
+  /**
+   * \brief Returns the radius of the ball around the centroid of a node which
+   * encloses its bounding box.
+   */
+  static double computeRadius(const ElementBVHNode &node) {
+    return (node.centroid_ - node.bbox_min_)
+        .cwiseMax(node.bbox_max_ - node.centroid_)
+        .norm();
+  }
+  /**
+   * \brief Returns the distance of a point to the bounding box of a node.
+   */
+  static double computeBoxDistance(const ElementBVHNode &node,
+                                   const Eigen::Vector3d &point) {
+    return (point.cwiseMax(node.bbox_min_).cwiseMin(node.bbox_max_) - point)
+        .norm();
+  }
+  /**
+   * \brief Pushes the sons of a node onto the stack, such that the son with
+   * the closest bounding box is on top.
+   */
+  void pushSons(const ElementBVHNode &node, const Eigen::Vector3d &point,
+                std::vector<int> *stack) const {
+    std::array<std::pair<double, int>, 4> sons;
+    const int number_of_sons = node.sons_.size();
+    for (auto i = 0; i < number_of_sons; ++i)
+      sons[i] = std::make_pair(computeBoxDistance(nodes_[node.sons_[i]], point),
+                               node.sons_[i]);
+    std::sort(sons.begin(), sons.begin() + number_of_sons,
+              std::greater<std::pair<double, int>>());
+    for (auto i = 0; i < number_of_sons; ++i) stack->push_back(sons[i].second);
+    return;
+  }
+  /**
+   * \brief Computes the distance of a point to an element by a projected
+   * Gauss-Newton method in the reference domain of the element, which starts
+   * from the midpoint of the element.
+   */
+  double computeElementDistance(const ElementTreeNode &element,
+                                const Eigen::Vector3d &point,
+                                Eigen::Vector2d *xi) const {
+    const BezierElement &bezier_element = bezier_elements_[element.id_];
+    const double h = element.get_h();
+    Eigen::Vector2d t(.5, .5);
+    double f = (bezier_element.eval(t) - point).squaredNorm();
+    SurfacePoint srf_pt;
+    Eigen::Matrix<double, 3, 2> J;
+    for (auto iter = 0; iter < 20; ++iter) {
+      bezier_element.updateSurfacePoint(&srf_pt, t, 1.);
+      const Eigen::Vector3d r = srf_pt.segment<3>(3) - point;
+      J.col(0) = h * srf_pt.segment<3>(6);
+      J.col(1) = h * srf_pt.segment<3>(9);
+      const Eigen::Matrix2d JTJ = J.transpose() * J;
+      const Eigen::Vector2d JTr = J.transpose() * r;
+      // coordinates on the boundary of the reference domain, where the
+      // gradient points outwards, are kept fixed
+      const bool fix_x = (t(0) == 0 && JTr(0) > 0) || (t(0) == 1 && JTr(0) < 0);
+      const bool fix_y = (t(1) == 0 && JTr(1) > 0) || (t(1) == 1 && JTr(1) < 0);
+      if (fix_x && fix_y) break;
+      Eigen::Vector2d delta;
+      if (fix_x)
+        delta << 0, -JTr(1) / JTJ(1, 1);
+      else if (fix_y)
+        delta << -JTr(0) / JTJ(0, 0), 0;
+      else
+        delta = -JTJ.ldlt().solve(JTr);
+      if (!delta.allFinite()) delta = -JTr / (JTJ.trace() + 1e-300);
+      // the step length minimizes the quadratic model along the step, which
+      // accounts for the curvature of the surface neglected by Gauss-Newton,
+      // and is followed by a backtracking line search on the projected steps
+      const double slope = 2 * JTr.dot(delta);
+      const double curvature =
+          (bezier_element.eval((t + delta).cwiseMax(0.).cwiseMin(1.)) - point)
+              .squaredNorm() -
+          f - slope;
+      double step = curvature > 0 ? -slope / (2 * curvature) : 1;
+      Eigen::Vector2d t_new = t;
+      double f_new = f;
+      for (auto l = 0; l < 10; ++l, step *= .5) {
+        t_new = (t + step * delta).cwiseMax(0.).cwiseMin(1.);
+        f_new = (bezier_element.eval(t_new) - point).squaredNorm();
+        if (f_new <= f) break;
+      }
+      if (f_new > f) break;
+      const double change = (t_new - t).norm();
+      t = t_new;
+      f = f_new;
+      if (change < 1e-12) break;
+    }
+    *xi = t;
+    return std::sqrt(f);
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// member variables
+  //////////////////////////////////////////////////////////////////////////////
+  std::vector<BezierElement> bezier_elements_;
+  std::vector<ElementBVHNode> nodes_;
+  int root_;
+};
+}  // namespace Bembel
+#endif  // BEMBEL_SRC_CLUSTERTREE_ELEMENTBVH_HPP_
@@ -28,6 +28,11 @@ namespace Bembel {
  * Z-curve. If an element get refined it gets replaced by it four sons element.
  * This core routine can handle adaptive refinement but with some limitations in
  * the resolution of neighborhood relations.
+ *
+ * All ElementTreeNodes are stored in a flat pool, which starts with the root
+ * and the patches. The four sons of an element are appended to the pool when
+ * it gets refined, such that uniform refinement stores the tree level by level
+ * and the leafs of each level contiguously in the order of the leaf iterator.
  */
 class ElementTree {
  public:
@@ -73,7 +78,13 @@ class ElementTree {
   /**
    * \brief Default constructor for the ElementTree class.
    */
-  ElementTree() {}
+  ElementTree()
+      : first_leaf_(-1),
+        last_leaf_(-1),
+        number_of_patches_(0),
+        max_level_(0),
+        number_of_points_(0),
+        number_of_elements_(0) {}
   /**
    * \brief Explicit constructor for the ElementTree class.
    *
@@ -107,53 +118,73 @@ class ElementTree {
     geometry_ = g.get_geometry_ptr();
     max_level_ = max_level;
     number_of_patches_ = geometry_->size();
+    // reserve the node pool for the uniform refinement up to max_level
+    nodes_.clear();
+    nodes_.reserve(1 + number_of_patches_ *
+                           (((std::size_t(1) << (2 * max_level + 2)) - 1) / 3));
+    refinement_offsets_.assign(1, 1);
     // create the patches and set up the topology
     {
-      std::vector<Eigen::Vector3d> uniquePts;
-      std::vector<ElementTreeNode *> patches;
-      Eigen::Vector3d v;
+      // evaluate the four corners of the unit square under the
+      // diffeomorphisms geo[i]
+      std::vector<Eigen::Vector3d> corners(4 * number_of_patches_);
+#pragma omp parallel for
+      for (auto i = 0; i < number_of_patches_; ++i)
+        for (auto j = 0; j < 4; ++j)
+          corners[4 * i + j] = (*geometry_)[i].eval(Constants::corners[0][j],
+                                                    Constants::corners[1][j]);
+      // identify coinciding corners by a spatial hash, whose cells have the
+      // size of the comparison tolerance. Thus, coinciding points are found
+      // in neighbouring cells.
+      std::unordered_map<std::array<long long, 3>, std::vector<int>,
+                         cell_hash>
+          uniquePts;
+      std::vector<Eigen::Vector3d> points;
+      std::vector<int> patches;
       number_of_points_ = 0;
       number_of_elements_ = number_of_patches_;
-      ElementTreeNode &root = root_;
-      root.sons_.resize(number_of_patches_);
+      nodes_.emplace_back();
+      nodes_[0].sons_.nodes_ = std::addressof(nodes_);
+      nodes_[0].sons_.first_ = 1;
+      nodes_[0].sons_.size_ = number_of_patches_;
       for (auto i = 0; i < number_of_patches_; ++i) {
-        root.sons_[i].adjcents_ = std::vector<ElementTreeNode *>(4, nullptr);
-        root.sons_[i].vertices_.resize(4);
-        root.sons_[i].id_ = i;
-        root.sons_[i].level_ = 0;
-        root.sons_[i].patch_ = i;
+        nodes_.emplace_back();
+        ElementTreeNode &patch = nodes_.back();
+        patch.sons_.nodes_ = std::addressof(nodes_);
+        patch.id_ = i;
+        patch.level_ = 0;
+        patch.patch_ = i;
         // add linked list structure to the panels
-        if (i == 0) {
-          root.sons_[0].prev_ = nullptr;
-          pfirst_ = std::addressof(root.sons_[0]);
-        } else {
-          root.sons_[i].prev_ = std::addressof(root.sons_[i - 1]);
-        }
-        if (i == number_of_patches_ - 1) {
-          root.sons_[i].next_ = nullptr;
-          plast_ = std::addressof(root.sons_[i]);
-        } else {
-          root.sons_[i].next_ = std::addressof(root.sons_[i + 1]);
-        }
-        // get images of the four corners of the unit square under the
-        // diffeomorphism geo[i]
+        patch.prev_ = i == 0 ? -1 : i;
+        patch.next_ = i == number_of_patches_ - 1 ? -1 : i + 2;
         for (auto j = 0; j < 4; ++j) {
-          v = (*geometry_)[i].eval(Constants::corners[0][j],
-                                   Constants::corners[1][j]);
-          unsigned int index = 0;
-          for (; index < uniquePts.size(); ++index)
-            if ((uniquePts[index] - v).norm() < Constants::pt_comp_tolerance)
-              break;
-          if (index != uniquePts.size()) {
-            root.sons_[i].vertices_[j] = index;
+          const Eigen::Vector3d &v = corners[4 * i + j];
+          const std::array<long long, 3> cell = computeCell(v);
+          // the point with the smallest index within the tolerance is used
+          int index = number_of_points_;
+          for (auto k = 0; k < 27; ++k) {
+            auto it = uniquePts.find({cell[0] + k % 3 - 1,
+                                      cell[1] + (k / 3) % 3 - 1,
+                                      cell[2] + k / 9 - 1});
+            if (it != uniquePts.end())
+              for (auto l : it->second)
+                if (l < index &&
+                    (points[l] - v).norm() < Constants::pt_comp_tolerance)
+                  index = l;
+          }
+          if (index != number_of_points_) {
+            patch.vertices_[j] = index;
           } else {
-            uniquePts.push_back(v);
-            root.sons_[i].vertices_[j] = number_of_points_;
+            uniquePts[cell].push_back(number_of_points_);
+            points.push_back(v);
+            patch.vertices_[j] = number_of_points_;
             ++number_of_points_;
           }
         }
-        patches.push_back(std::addressof(root.sons_[i]));
+        patches.push_back(i + 1);
       }
+      first_leaf_ = 1;
+      last_leaf_ = number_of_patches_;
       updateTopology(patches);
     }
     for (auto i = 0; i < max_level; ++i) refineUniformly();
@@ -161,34 +192,163 @@ class ElementTree {
   }
   //////////////////////////////////////////////////////////////////////////////
   /**
-   * \brief Refine the given element or it's sons.
-   *
-   * This function refines an element recursively. If the given element is
-   * already refined than iterate all sons and refine them and so on.
-   */
-  void refineUniformly_recursion(ElementTreeNode &el) {
-    if (el.sons_.size()) {
-      for (auto i = 0; i < el.sons_.size(); ++i)
-        refineUniformly_recursion(el.sons_[i]);
-    } else {
-      refineLeaf(el);
+   * \brief Refine all leafs of the given element.
+   *
+   * The leafs are refined in parallel. The result coincides with refining the
+   * leafs one after another in the order of the leaf iterator, i.e., a new
+   * point on an edge shared by two refined leafs is introduced by the leaf
+   * which comes first in this order.
+   *
+   * \warning The sons are appended to the node pool, which may reallocate it.
+   * This invalidates all pointers, references and iterators to
+   * ElementTreeNodes, e.g., the ones held by an ElementBVH. The data of a
+   * ClusterTree which depends on the elements is recomputed by
+   * ClusterTree::updateAfterRefinement.
+   */
+  void refineLeafs(const ElementTreeNode &el) {
+    std::vector<int> leafs;
+    for (auto it = el.cbegin(); it != el.cend(); ++it)
+      leafs.push_back(std::distance(nodes_.data(), std::addressof(*it)));
+    const int number_of_leafs = leafs.size();
+    std::vector<int> position(nodes_.size(), -1);
+    for (auto k = 0; k < number_of_leafs; ++k) position[leafs[k]] = k;
+    // determine the position of the leafs with respect to their neighbours
+    // and count the points introduced by each leaf
+    std::vector<std::array<int, 4>> ref_neighbours(number_of_leafs);
+    std::vector<std::array<int, 5>> pt_ids(number_of_leafs);
+    std::vector<int> pt_offsets(number_of_leafs + 1, 0);
+#pragma omp parallel for
+    for (auto k = 0; k < number_of_leafs; ++k) {
+      const ElementTreeNode &cur_el = nodes_[leafs[k]];
+      for (auto i = 0; i < 4; ++i) {
+        ref_neighbours[k][i] = -1;
+        pt_ids[k][i] = -1;
+        if (cur_el.adjcents_[i] < 0) continue;
+        const ElementTreeNode &ref_cur_neighbour = nodes_[cur_el.adjcents_[i]];
+        ref_neighbours[k][i] = 0;
+        for (auto j = 0; j < 4; ++j)
+          if (ref_cur_neighbour.adjcents_[j] == leafs[k]) {
+            ref_neighbours[k][i] = j;
+            break;
+          }
+        const int ref = ref_neighbours[k][i];
+        if (ref_cur_neighbour.sons_.size()) {
+          // the neighbour has been refined before
+          pt_ids[k][i] = ref_cur_neighbour.sons_[ref].vertices_[(ref + 1) % 4];
+        } else if (position[cur_el.adjcents_[i]] >= 0 &&
+                   position[cur_el.adjcents_[i]] < k) {
+          // the neighbour introduces the point, which is resolved below
+          pt_ids[k][i] = -2;
+        }
+      }
+      // the midpoint of the current element is always a new point
+      pt_offsets[k + 1] = 1 + std::count(pt_ids[k].begin(),
+                                         pt_ids[k].begin() + 4, -1);
+    }
+    for (auto k = 0; k < number_of_leafs; ++k)
+      pt_offsets[k + 1] += pt_offsets[k];
+#pragma omp parallel for
+    for (auto k = 0; k < number_of_leafs; ++k) {
+      int pt_id = number_of_points_ + pt_offsets[k];
+      for (auto i = 0; i < 4; ++i)
+        if (pt_ids[k][i] == -1) pt_ids[k][i] = pt_id++;
+      pt_ids[k][4] = pt_id;
     }
+    // set up the new elements
+    const int first_son = nodes_.size();
+    const int prev = nodes_[leafs.front()].prev_;
+    const int next = nodes_[leafs.back()].next_;
+    nodes_.resize(first_son + 4 * number_of_leafs);
+    refinement_offsets_.push_back(first_son);
+#pragma omp parallel for
+    for (auto k = 0; k < number_of_leafs; ++k) {
+      ElementTreeNode &cur_el = nodes_[leafs[k]];
+      std::array<int, 5> &ptIds = pt_ids[k];
+      for (auto i = 0; i < 4; ++i)
+        if (ptIds[i] == -2) {
+          const int neighbour = position[cur_el.adjcents_[i]];
+          ptIds[i] = pt_ids[neighbour][ref_neighbours[k][i]];
+        }
+      cur_el.sons_.first_ = first_son + 4 * k;
+      cur_el.sons_.size_ = 4;
+      for (auto i = 0; i < 4; ++i) {
+        ElementTreeNode &son = nodes_[first_son + 4 * k + i];
+        // add linked list structure to the panels
+        son.prev_ = first_son + 4 * k + i - 1;
+        son.next_ = first_son + 4 * k + i + 1;
+        son.sons_.nodes_ = std::addressof(nodes_);
+        son.patch_ = cur_el.patch_;
+        son.level_ = cur_el.level_ + 1;
+        son.id_ = 4 * cur_el.id_ + i;
+        son.llc_(0) = cur_el.llc_(0) +
+                      Constants::llcs[0][i] / double(1 << cur_el.level_);
+        son.llc_(1) = cur_el.llc_(1) +
+                      Constants::llcs[1][i] / double(1 << cur_el.level_);
+      }
+      cur_el.prev_ = -1;
+      cur_el.next_ = -1;
+      // set vertices
+      // first element
+      nodes_[first_son + 4 * k].vertices_ = {
+          {cur_el.vertices_[0], ptIds[0], ptIds[4], ptIds[3]}};
+      // second element
+      nodes_[first_son + 4 * k + 1].vertices_ = {
+          {ptIds[0], cur_el.vertices_[1], ptIds[1], ptIds[4]}};
+      // third element
+      nodes_[first_son + 4 * k + 2].vertices_ = {
+          {ptIds[4], ptIds[1], cur_el.vertices_[2], ptIds[2]}};
+      // fourth element
+      nodes_[first_son + 4 * k + 3].vertices_ = {
+          {ptIds[3], ptIds[4], ptIds[2], cur_el.vertices_[3]}};
+    }
+    // fix adjecency relations among the sons and with respect to the sons of
+    // the neighbours which are refined before. Every edge is handled by one
+    // leaf only, such that the leafs write to distinct adjacencies.
+#pragma omp parallel for
+    for (auto k = 0; k < number_of_leafs; ++k) {
+      const ElementTreeNode &cur_el = nodes_[leafs[k]];
+      std::vector<int> elements;
+      for (auto i = 0; i < 4; ++i) elements.push_back(cur_el.sons_.first_ + i);
+      updateTopology(elements);
+      for (auto i = 0; i < 4; ++i) {
+        if (cur_el.adjcents_[i] < 0) continue;
+        const ElementTreeNode &ref_cur_neighbour = nodes_[cur_el.adjcents_[i]];
+        if (ref_cur_neighbour.sons_.size() &&
+            (position[cur_el.adjcents_[i]] < 0 ||
+             position[cur_el.adjcents_[i]] < k))
+          linkSonsAcrossEdge(cur_el, i, ref_cur_neighbour,
+                             ref_neighbours[k][i]);
+      }
+    }
+    // connect the new leafs to the leaf sequence
+    nodes_[first_son].prev_ = prev;
+    nodes_[nodes_.size() - 1].next_ = next;
+    if (prev >= 0) nodes_[prev].next_ = first_son;
+    if (next >= 0) nodes_[next].prev_ = nodes_.size() - 1;
+    if (leafs.front() == first_leaf_) first_leaf_ = first_son;
+    if (leafs.back() == last_leaf_) last_leaf_ = nodes_.size() - 1;
+    number_of_points_ += pt_offsets.back();
+    number_of_elements_ += 3 * number_of_leafs;
+    for (auto k = 0; k < number_of_leafs; ++k)
+      max_level_ = std::max(max_level_, nodes_[leafs[k]].level_ + 1);
     return;
   }
   //////////////////////////////////////////////////////////////////////////////
   /**
-   * \brief Refine all patches uniformly
+   * \brief Refine all patches uniformly, see refineLeafs for the invalidation
+   * of pointers to ElementTreeNodes.
    */
   void refineUniformly() {
-    refineUniformly_recursion(root_);
+    refineLeafs(nodes_[0]);
     return;
   }
   //////////////////////////////////////////////////////////////////////////////
   /**
-   * \brief Refine a given patch.
+   * \brief Refine a given patch, see refineLeafs for the invalidation of
+   * pointers to ElementTreeNodes.
    */
   void refinePatch(int patch) {
-    refineUniformly_recursion(root_.sons_[patch]);
+    refineLeafs(nodes_[patch + 1]);
     return;
   }
   //////////////////////////////////////////////////////////////////////////////
@@ -209,22 +369,27 @@ class ElementTree {
       idct->resize(number_of_points_);
       idct->setZero();
     }
+    // each point is evaluated by the last of its elements, such that the
+    // result does not depend on the number of threads
+    std::vector<const ElementTreeNode *> elements;
+    elements.reserve(number_of_elements_);
+    std::vector<int> owner(number_of_points_);
     for (auto it = pbegin(); it != pend(); ++it) {
-      double h = double(1) / double(1 << it->level_);
-      pts.col(it->vertices_[0]) =
-          (*geometry_)[it->patch_].eval(it->llc_(0), it->llc_(1));
-      pts.col(it->vertices_[1]) =
-          (*geometry_)[it->patch_].eval(it->llc_(0) + h, it->llc_(1));
-      pts.col(it->vertices_[2]) =
-          (*geometry_)[it->patch_].eval(it->llc_(0) + h, it->llc_(1) + h);
-      pts.col(it->vertices_[3]) =
-          (*geometry_)[it->patch_].eval(it->llc_(0), it->llc_(1) + h);
-      if (idct != nullptr) {
-        ++((*idct)(it->vertices_[0]));
-        ++((*idct)(it->vertices_[1]));
-        ++((*idct)(it->vertices_[2]));
-        ++((*idct)(it->vertices_[3]));
+      for (auto j = 0; j < 4; ++j) {
+        owner[it->vertices_[j]] = 4 * elements.size() + j;
+        if (idct != nullptr) ++((*idct)(it->vertices_[j]));
       }
+      elements.push_back(std::addressof(*it));
+    }
+#pragma omp parallel for
+    for (auto i = 0; i < elements.size(); ++i) {
+      const ElementTreeNode &el = *(elements[i]);
+      const double h = el.get_h();
+      for (auto j = 0; j < 4; ++j)
+        if (owner[el.vertices_[j]] == 4 * i + j)
+          pts.col(el.vertices_[j]) = (*geometry_)[el.patch_].eval(
+              el.llc_(0) + Constants::corners[0][j] * h,
+              el.llc_(1) + Constants::corners[1][j] * h);
     }
     return pts;
   }
@@ -273,13 +438,22 @@ class ElementTree {
    *
    * \return Reference to the root ElementTreeNode.
    */
-  ElementTreeNode &root() { return root_; }
+  ElementTreeNode &root() { return nodes_[0]; }
   /**
    * \brief Return const reference to the root ElementTreeNode.
    *
    * \return Const Reference to the root ElementTreeNode.
    */
-  const ElementTreeNode &root() const { return root_; }
+  const ElementTreeNode &root() const { return nodes_[0]; }
+  /**
+   * \brief Return const reference to the node pool.
+   *
+   * The pool starts with the root followed by the patches. The sons of each
+   * element are stored contiguously after their father.
+   *
+   * \return Const reference to the vector of all ElementTreeNodes.
+   */
+  const std::vector<ElementTreeNode> &get_nodes() const { return nodes_; }
   /**
    * \brief Return const reference to the Geometry.
    *
@@ -296,7 +470,7 @@ class ElementTree {
    * \return Returns a ElementTreeNode::const_iterator object.
    */
   ElementTreeNode::const_iterator pbegin() const {
-    return ElementTreeNode::const_iterator(pfirst_);
+    return ElementTreeNode::const_iterator(root().get_node(first_leaf_));
   }
   /**
    * \brief Returns an iterator one past the end of the sequence represented by
@@ -305,7 +479,8 @@ class ElementTree {
    * \return Returns a ElementTreeNode::const_iterator object.
    */
   ElementTreeNode::const_iterator pend() const {
-    return ElementTreeNode::const_iterator(plast_->next_);
+    return ElementTreeNode::const_iterator(
+        root().get_node(last_leaf_)->get_next());
   }
   /**
    * \brief Returns an iterator to the beginning of the sequence represented by
@@ -354,22 +529,31 @@ class ElementTree {
   Eigen::MatrixXd computeElementEnclosings() {
     // compute point list
     Eigen::MatrixXd P = generatePointList();
-    for (auto i = 0; i < root_.sons_.size(); ++i)
-      computeElementEnclosings_recursion(root_.sons_[i], P);
+    // the sons are appended to the pool by a later refinement than their
+    // father, such that a backward sweep over the refinements handles the
+    // elements bottom up
+    for (int l = refinement_offsets_.size() - 1; l >= 0; --l) {
+      const int end = l + 1 < refinement_offsets_.size()
+                          ? refinement_offsets_[l + 1]
+                          : nodes_.size();
+#pragma omp parallel for
+      for (auto i = refinement_offsets_[l]; i < end; ++i)
+        computeElementEnclosing(nodes_[i], P);
+    }
     return P;
   }
   //////////////////////////////////////////////////////////////////////////////
   /**
-   * \brief Computes enclosing balls of one element and all its sons.
+   * \brief Computes the enclosing ball of one element. The enclosing balls of
+   * its sons need to be computed beforehand.
    *
-   * \param el ElementTreeNode to start the recursion.
+   * \param el ElementTreeNode to compute the enclosing ball for.
    * \param P Point list of the vertices.
    */
-  void computeElementEnclosings_recursion(ElementTreeNode &el,
-                                          const Eigen::MatrixXd &P) {
+  void computeElementEnclosing(ElementTreeNode &el,
+                               const Eigen::MatrixXd &P) const {
     Eigen::Vector3d mp1, mp2;
     double r1, r2;
-    // compute point list
     if (!el.sons_.size()) {
       // assign enclosing balls to leafs
       util::computeEnclosingBall(&mp1, &r1, P.col(el.vertices_[0]), 0,
@@ -379,10 +563,7 @@ class ElementTree {
       util::computeEnclosingBall(&(el.midpoint_), &(el.radius_), mp1, r1, mp2,
                                  r2);
     } else {
-      // handle the four(!!!) children
-      for (auto i = 0; i < 4; ++i)
-        computeElementEnclosings_recursion(el.sons_[i], P);
-      // assign enclosing balls to fathers bottom up
+      // assign enclosing balls to fathers bottom up from the four(!!!) sons
       util::computeEnclosingBall(&mp1, &r1, el.sons_[0].midpoint_,
                                  el.sons_[0].radius_, el.sons_[2].midpoint_,
                                  el.sons_[2].radius_);
@@ -470,10 +651,10 @@ class ElementTree {
     unsigned int i = 0;
     for (auto it = pbegin(); it != pend(); ++it) {
       for (auto j = 0; j < 4; ++j)
-        if (it->adjcents_[j] == nullptr) {
+        if (it->adjcents_[j] < 0) {
           retval[i] = -1;
           break;
-        } else if (it->adjcents_[j]->patch_ != it->patch_) {
+        } else if (nodes_[it->adjcents_[j]].patch_ != it->patch_) {
           ++(retval[i]);
         }
       ++i;
@@ -509,18 +690,18 @@ class ElementTree {
   //////////////////////////////////////////////////////////////////////////////
   std::vector<std::array<int, 4>> patchTopologyInfo() const {
     std::vector<std::array<int, 4>> retval;
-    for (auto it = root_.sons_.begin(); it != root_.sons_.end(); ++it) {
+    for (auto it = root().sons_.begin(); it != root().sons_.end(); ++it) {
       for (auto j = 0; j < 4; ++j) {
         // do we have a neighbour?
-        if (it->adjcents_[j] != nullptr) {
-          const ElementTreeNode &cur_neighbour = *(it->adjcents_[j]);
+        if (it->adjcents_[j] >= 0) {
+          const ElementTreeNode &cur_neighbour = nodes_[it->adjcents_[j]];
           // add the edge only if it->id_ < neighbour->id_
           // otherwise the edge has already been added
           if (it->id_ < cur_neighbour.id_) {
             int k = 0;
             for (; k < 4; ++k)
-              if (cur_neighbour.adjcents_[k] != nullptr &&
-                  cur_neighbour.adjcents_[k]->id_ == it->id_)
+              if (cur_neighbour.adjcents_[k] >= 0 &&
+                  nodes_[cur_neighbour.adjcents_[k]].id_ == it->id_)
                 break;
             retval.push_back({it->id_, cur_neighbour.id_, j, k});
           }
@@ -570,6 +751,26 @@ class ElementTree {
   //////////////////////////////////////////////////////////////////////////////
   /// methods
   //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Hash of the cells of the uniform grid used to identify points.
+   */
+  struct cell_hash {
+    std::size_t operator()(const std::array<long long, 3> &cell) const {
+      // the products are computed unsigned, since they may overflow
+      return (std::size_t(cell[0]) * 73856093u) ^
+             (std::size_t(cell[1]) * 19349663u) ^
+             (std::size_t(cell[2]) * 83492791u);
+    }
+  };
+  /**
+   * \brief Computes the cell of a point in the uniform grid, whose cells have
+   * the size of the comparison tolerance.
+   */
+  static std::array<long long, 3> computeCell(const Eigen::Vector3d &v) {
+    return {{(long long)std::floor(v(0) / Constants::pt_comp_tolerance),
+             (long long)std::floor(v(1) / Constants::pt_comp_tolerance),
+             (long long)std::floor(v(2) / Constants::pt_comp_tolerance)}};
+  }
   template <typename T>
   struct isEqual {
     bool operator()(const T &v1, const T &v2) const {
@@ -581,28 +782,30 @@ class ElementTree {
    *        of a refined element
    */
   //////////////////////////////////////////////////////////////////////////////
-  void updateTopology(const std::vector<ElementTreeNode *> &elements) {
-    std::map<std::array<int, 2>, ElementTreeNode *> edges;
+  void updateTopology(const std::vector<int> &elements) {
+    std::map<std::array<int, 2>, int> edges;
     std::array<int, 2> e1, e2;
     // generate edge list for all elements in question
-    for (auto i = 0; i < elements.size(); ++i)
+    for (auto i = 0; i < elements.size(); ++i) {
+      ElementTreeNode &element = nodes_[elements[i]];
       for (auto j = 0; j < 4; ++j) {
         // compute a unique id for each edge
-        const int v1 = elements[i]->vertices_[j];
-        const int v2 = elements[i]->vertices_[(j + 1) % 4];
+        const int v1 = element.vertices_[j];
+        const int v2 = element.vertices_[(j + 1) % 4];
         e1 = {v1 < v2 ? v1 : v2, v1 < v2 ? v2 : v1};
         // perferm a look up if the edge is already existing.
         auto it = edges.find(e1);
         // if so, identify the two neighbours
         if (it != edges.end()) {
-          elements[i]->adjcents_[j] = it->second;
+          ElementTreeNode &neighbour = nodes_[it->second];
+          element.adjcents_[j] = it->second;
           // now find the edge also in the patch that added it to the set
           for (auto k = 0; k < 4; ++k) {
-            const int v3 = it->second->vertices_[k];
-            const int v4 = it->second->vertices_[(k + 1) % 4];
+            const int v3 = neighbour.vertices_[k];
+            const int v4 = neighbour.vertices_[(k + 1) % 4];
             e2 = {v3 < v4 ? v3 : v4, v3 < v4 ? v4 : v3};
             if (e1 == e2) {
-              it->second->adjcents_[k] = elements[i];
+              neighbour.adjcents_[k] = elements[i];
               break;
             }
           }
@@ -611,139 +814,47 @@ class ElementTree {
           edges.insert(std::make_pair(e1, elements[i]));
         }
       }
+    }
     return;
   }
-  //////////////////////////////////////////////////////////////////////////////
   /**
-   * \brief This function refines the given ElementTreeNode.
-   *
-   * The function introduces 4 new elements and takes care of the newly
-   * introduces vertices. Furthermore, all the neighborhood relation of all
-   * surrounding elements are resolved.
-   */
-  void refineLeaf(ElementTreeNode &cur_el) {
-    // check if we have actually a panel
-    if (cur_el.sons_.size()) return;
-    std::vector<int> ptIds(5);
-    std::vector<int> refNeighbours(4);
-    std::vector<ElementTreeNode *> elements;
-    // determine position of p with respect to its neighbours
-    for (auto i = 0; i < 4; ++i) {
-      // is there a neighbour?
-      if (cur_el.adjcents_[i] != nullptr) {
-        for (auto j = 0; j < 4; ++j)
-          if (cur_el.adjcents_[i]->adjcents_[j] == std::addressof(cur_el)) {
-            refNeighbours[i] = j;
-            break;
-          }
-      } else {
-        refNeighbours[i] = -1;
-      }
-    }
-    //  determine new points
-    for (auto i = 0; i < 4; ++i) {
-      // is there a neighbour?
-      if (cur_el.adjcents_[i] != nullptr) {
-        ElementTreeNode &ref_cur_neighbour = *(cur_el.adjcents_[i]);
-        // is the neighbour already refined?
-        if (ref_cur_neighbour.sons_.size()) {
-          // this is the midpoint of the shared edge
-          ptIds[i] = ref_cur_neighbour.sons_[refNeighbours[i]]
-                         .vertices_[(refNeighbours[i] + 1) % 4];
-          // these are the two elements adjacent to the edge
-          elements.push_back(
-              std::addressof(ref_cur_neighbour.sons_[refNeighbours[i]]));
-          elements.push_back(std::addressof(
-              ref_cur_neighbour.sons_[(refNeighbours[i] + 1) % 4]));
-        } else {
-          // otherwise add the point id to the tree
-          ptIds[i] = number_of_points_;
-          ++number_of_points_;
+   * \brief Links the two sons of an element along one of its edges to the two
+   * sons of a refined neighbour along the shared edge. Only the adjacencies
+   * across this edge are written.
+   *
+   * \param element The refined element.
+   * \param edge The local index of the edge in the element.
+   * \param neighbour The refined neighbour across the edge.
+   * \param ref The local index of the edge in the neighbour.
+   */
+  void linkSonsAcrossEdge(const ElementTreeNode &element, int edge,
+                          const ElementTreeNode &neighbour, int ref) {
+    // the sons on an edge of their father have the same local index for it
+    for (auto i : {edge, (edge + 1) % 4}) {
+      const int son = element.sons_.first_ + i;
+      const int v1 = nodes_[son].vertices_[edge];
+      const int v2 = nodes_[son].vertices_[(edge + 1) % 4];
+      for (auto j : {ref, (ref + 1) % 4}) {
+        const int other = neighbour.sons_.first_ + j;
+        const int v3 = nodes_[other].vertices_[ref];
+        const int v4 = nodes_[other].vertices_[(ref + 1) % 4];
+        if ((v1 == v3 && v2 == v4) || (v1 == v4 && v2 == v3)) {
+          nodes_[son].adjcents_[edge] = other;
+          nodes_[other].adjcents_[ref] = son;
         }
-      } else {
-        // otherwise add the point id to the tree
-        ptIds[i] = number_of_points_;
-        ++number_of_points_;
       }
     }
-    // add midpoint of the current element, which is always a new point
-    ptIds[4] = number_of_points_;
-    ++number_of_points_;
-    // set up new elements
-    cur_el.sons_.resize(4);
-    number_of_elements_ += 3;
-    max_level_ =
-        max_level_ < cur_el.level_ + 1 ? cur_el.level_ + 1 : max_level_;
-    //  auto it = leafs_.find(compute_global_id(cur_el));
-    //  if (it != leafs_.end()) leafs_.erase(it);
-    for (auto i = 0; i < 4; ++i) {
-      // add linked list structure to the panels
-      //////////////////////////////////////////////////////////////////////////
-      if (i == 0) {
-        cur_el.sons_[i].prev_ = cur_el.prev_;
-        if (cur_el.prev_ != nullptr)
-          (cur_el.prev_)->next_ = std::addressof(cur_el.sons_[i]);
-        cur_el.prev_ = nullptr;
-        if (std::addressof(cur_el) == pfirst_)
-          pfirst_ = std::addressof(cur_el.sons_[i]);
-
-      } else {
-        cur_el.sons_[i].prev_ = std::addressof(cur_el.sons_[i - 1]);
-      }
-      if (i == 3) {
-        cur_el.sons_[i].next_ = cur_el.next_;
-        if (cur_el.next_ != nullptr)
-          (cur_el.next_)->prev_ = std::addressof(cur_el.sons_[i]);
-        cur_el.next_ = nullptr;
-        if (std::addressof(cur_el) == plast_)
-          plast_ = std::addressof(cur_el.sons_[i]);
-      } else {
-        cur_el.sons_[i].next_ = std::addressof(cur_el.sons_[i + 1]);
-      }
-      //////////////////////////////////////////////////////////////////////////
-      cur_el.sons_[i].patch_ = cur_el.patch_;
-      cur_el.sons_[i].level_ = cur_el.level_ + 1;
-      cur_el.sons_[i].id_ = 4 * cur_el.id_ + i;
-      cur_el.sons_[i].adjcents_ = std::vector<ElementTreeNode *>(4, nullptr);
-      cur_el.sons_[i].llc_(0) =
-          cur_el.llc_(0) + Constants::llcs[0][i] / double(1 << cur_el.level_);
-      cur_el.sons_[i].llc_(1) =
-          cur_el.llc_(1) + Constants::llcs[1][i] / double(1 << cur_el.level_);
-      elements.push_back(std::addressof(cur_el.sons_[i]));
-    }
-    // set vertices
-    // first element
-    cur_el.sons_[0].vertices_.push_back(cur_el.vertices_[0]);
-    cur_el.sons_[0].vertices_.push_back(ptIds[0]);
-    cur_el.sons_[0].vertices_.push_back(ptIds[4]);
-    cur_el.sons_[0].vertices_.push_back(ptIds[3]);
-    // second element
-    cur_el.sons_[1].vertices_.push_back(ptIds[0]);
-    cur_el.sons_[1].vertices_.push_back(cur_el.vertices_[1]);
-    cur_el.sons_[1].vertices_.push_back(ptIds[1]);
-    cur_el.sons_[1].vertices_.push_back(ptIds[4]);
-    // third element
-    cur_el.sons_[2].vertices_.push_back(ptIds[4]);
-    cur_el.sons_[2].vertices_.push_back(ptIds[1]);
-    cur_el.sons_[2].vertices_.push_back(cur_el.vertices_[2]);
-    cur_el.sons_[2].vertices_.push_back(ptIds[2]);
-    // fourth element
-    cur_el.sons_[3].vertices_.push_back(ptIds[3]);
-    cur_el.sons_[3].vertices_.push_back(ptIds[4]);
-    cur_el.sons_[3].vertices_.push_back(ptIds[2]);
-    cur_el.sons_[3].vertices_.push_back(cur_el.vertices_[3]);
-    // fix adjecency relations
-    updateTopology(elements);
-
     return;
   }
   //////////////////////////////////////////////////////////////////////////////
   /// member variables
   //////////////////////////////////////////////////////////////////////////////
   std::shared_ptr<PatchVector> geometry_;
-  ElementTreeNode root_;
-  ElementTreeNode *pfirst_;
-  ElementTreeNode *plast_;
+  std::vector<ElementTreeNode> nodes_;
+  // offsets of the nodes appended to the pool by each refinement
+  std::vector<int> refinement_offsets_;
+  int first_leaf_;
+  int last_leaf_;
   int number_of_patches_;
   int max_level_;
   int number_of_points_;
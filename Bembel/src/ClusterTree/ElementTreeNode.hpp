@@ -17,9 +17,57 @@ namespace Bembel {
 /**
  *  \ingroup ClusterTree
  *  \brief The ElementTreeNode corresponds to an element in the element tree.
+ *
+ *  The nodes are stored in a flat pool owned by the ElementTree, in which the
+ *  sons of an element are contiguous and stored after their father. All links
+ *  between the nodes, i.e., the sons, the neighbours and the leaf sequence,
+ *  are indices into this pool. Hence, a node does not own any heap memory.
  */
 class ElementTreeNode {
  public:
+  /**
+   * \brief Contiguous range of the sons of an element within the node pool.
+   * It behaves like a const container of ElementTreeNodes.
+   */
+  struct son_range {
+    son_range() noexcept : nodes_(nullptr), first_(-1), size_(0) {}
+    /**
+     * \brief Returns the number of sons.
+     */
+    std::size_t size() const { return size_; }
+    /**
+     * \brief Accesses the i-th son.
+     */
+    const ElementTreeNode &operator[](int i) const {
+      return (*nodes_)[first_ + i];
+    }
+    /**
+     * \brief Accesses the first son.
+     */
+    const ElementTreeNode &front() const { return (*nodes_)[first_]; }
+    /**
+     * \brief Accesses the last son.
+     */
+    const ElementTreeNode &back() const {
+      return (*nodes_)[first_ + size_ - 1];
+    }
+    /**
+     * \brief Returns a pointer to the first son.
+     */
+    const ElementTreeNode *begin() const {
+      return size_ ? nodes_->data() + first_ : nullptr;
+    }
+    /**
+     * \brief Returns a pointer one past the last son.
+     */
+    const ElementTreeNode *end() const {
+      return size_ ? nodes_->data() + first_ + size_ : nullptr;
+    }
+
+    std::vector<ElementTreeNode> *nodes_;  /// node pool of the ElementTree
+    int first_;                            /// index of the first son
+    int size_;                             /// number of sons
+  };
   /**
    * \brief iterator struct for element tree nodes. They may be used to iterator
    * over the elements in a cluster. To do so, however, the cluster must be set
@@ -50,7 +98,7 @@ class ElementTreeNode {
      * \brief Prefix increment.
      */
     const_iterator &operator++() {
-      m_ptr = m_ptr->next_;
+      m_ptr = m_ptr->get_next();
       return *this;
     }
 
@@ -86,28 +134,21 @@ class ElementTreeNode {
    * \brief Default constructor.
    */
   ElementTreeNode() noexcept
-      : prev_(nullptr),
-        next_(nullptr),
+      : prev_(-1),
+        next_(-1),
+        radius_(std::numeric_limits<double>::infinity()),
         id_(-1),
         level_(-1),
-        patch_(-1),
-        radius_(std::numeric_limits<double>::infinity()) {
+        patch_(-1) {
+    adjcents_.fill(-1);
+    vertices_.fill(-1);
     midpoint_ << 0., 0., 0.;
     llc_ << 0., 0.;
   }
   /**
-   * \brief Move constructor.
+   * \brief Move constructor, which is used when the node pool grows.
    */
-  ElementTreeNode(ElementTreeNode &&other) noexcept {
-    midpoint_.swap(other.midpoint_);
-    llc_.swap(other.llc_);
-    vertices_ = std::move(other.vertices_);
-    radius_ = other.radius_;
-    id_ = other.id_;
-    patch_ = other.patch_;
-    sons_ = std::move(other.sons_);
-    adjcents_ = std::move(other.adjcents_);
-  }
+  ElementTreeNode(ElementTreeNode &&other) noexcept = default;
 
   /**
    * \brief Copy constructor (deleted).
@@ -141,6 +182,8 @@ class ElementTreeNode {
     std::cout << "llc:        " << llc_.transpose() << std::endl;
     std::cout << "p s n:      " << prev_ << " " << this << " " << next_
               << std::endl;
+    std::cout << "sons:       " << sons_.first_ << " " << sons_.size_
+              << std::endl;
     std::cout << "neighbours: ";
     for (auto i = 0; i < adjcents_.size(); ++i)
       std::cout << adjcents_[i] << " ";
@@ -199,6 +242,25 @@ class ElementTreeNode {
    */
   int get_level() const { return level_; }
   //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Returns a pointer to the node with the given index in the node pool
+   * of the ElementTree or nullptr if the index is negative.
+   *
+   * \param index Index of the node in the pool.
+   * \return Pointer to the node.
+   */
+  ElementTreeNode *get_node(int index) const {
+    return index < 0 ? nullptr : sons_.nodes_->data() + index;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Returns a pointer to the next element in the leaf sequence or
+   * nullptr if this is the last one.
+   *
+   * \return Pointer to the next element.
+   */
+  ElementTreeNode *get_next() const { return get_node(next_); }
+  //////////////////////////////////////////////////////////////////////////////
   /**
    * \brief Returns a const reference to the first son if any or itself.
    *
@@ -241,7 +303,7 @@ class ElementTreeNode {
    */
   const_iterator cend() const {
     const ElementTreeNode &el = this->back();
-    return const_iterator(const_cast<ElementTreeNode *>(el.next_));
+    return const_iterator(el.get_next());
   }
   //////////////////////////////////////////////////////////////////////////////
   /**
@@ -264,13 +326,13 @@ class ElementTreeNode {
   //////////////////////////////////////////////////////////////////////////////
   /// member variables
   //////////////////////////////////////////////////////////////////////////////
-  std::vector<ElementTreeNode> sons_;        /// children
-  std::vector<ElementTreeNode *> adjcents_;  /// neighbouring elements indices
-  std::vector<int> vertices_;                /// indices of the vertices
-  Eigen::Vector3d midpoint_;                 /// midpoint of the element
-  Eigen::Vector2d llc_;                      /// lower left corner on [0,1]^2
-  ElementTreeNode *prev_;
-  ElementTreeNode *next_;
+  son_range sons_;               /// children
+  std::array<int, 4> adjcents_;  /// pool indices of the neighbouring elements
+  std::array<int, 4> vertices_;  /// indices of the vertices
+  Eigen::Vector3d midpoint_;     /// midpoint of the element
+  Eigen::Vector2d llc_;          /// lower left corner on [0,1]^2
+  int prev_;       /// pool index of the previous element in the leaf sequence
+  int next_;       /// pool index of the next element in the leaf sequence
   double radius_;  /// radius of the element
   int id_;         /// element id with respect to the level
   int level_;      /// level of the element
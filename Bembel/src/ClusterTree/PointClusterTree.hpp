@@ -0,0 +1,125 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+#ifndef BEMBEL_SRC_CLUSTERTREE_POINTCLUSTERTREE_HPP_
+#define BEMBEL_SRC_CLUSTERTREE_POINTCLUSTERTREE_HPP_
+
+namespace Bembel {
+/**
+ *  \ingroup ClusterTree
+ *  \brief A cluster of points in the PointClusterTree.
+ *
+ *  The points of the cluster are indices_[begin_], ..., indices_[end_ - 1] of
+ *  the PointClusterTree it belongs to.
+ */
+struct PointCluster {
+  Eigen::Vector3d bbox_min_;  /// lower corner of the bounding box
+  Eigen::Vector3d bbox_max_;  /// upper corner of the bounding box
+  Eigen::Vector3d midpoint_;  /// midpoint of the enclosing ball
+  double radius_;             /// radius of the enclosing ball
+  int begin_;                 /// first index of the cluster in indices_
+  int end_;                   /// one past the last index in indices_
+  int parent_;                /// index of the father, -1 for the root
+  std::vector<int> sons_;     /// indices of the sons
+  int size() const { return end_ - begin_; }
+};
+/**
+ *  \ingroup ClusterTree
+ *  \brief Binary cluster tree over a cloud of points in space, e.g., the
+ *  evaluation points of a potential.
+ *
+ *  Clusters are bisected at the median along the longest side of their
+ *  bounding box until they contain at most leaf_size points. The clusters are
+ *  stored in a flat vector, the root being the first one.
+ */
+class PointClusterTree {
+ public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// constructors
+  //////////////////////////////////////////////////////////////////////////////
+  PointClusterTree() {}
+  PointClusterTree(const Eigen::Matrix<double, Eigen::Dynamic, 3> &points,
+                   int leaf_size) {
+    init_PointClusterTree(points, leaf_size);
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// init
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Sets up the cluster tree.
+   *
+   * \param points Points to be clustered, one point per row.
+   * \param leaf_size Maximal number of points in a leaf.
+   */
+  void init_PointClusterTree(
+      const Eigen::Matrix<double, Eigen::Dynamic, 3> &points, int leaf_size) {
+    assert(leaf_size > 0 && "leaf size must be positive");
+    indices_.resize(points.rows());
+    for (auto i = 0; i < indices_.size(); ++i) indices_[i] = i;
+    clusters_.clear();
+    appendCluster(points, 0, points.rows(), -1, leaf_size);
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// getter
+  //////////////////////////////////////////////////////////////////////////////
+  const std::vector<PointCluster> &get_clusters() const { return clusters_; }
+  const std::vector<int> &get_indices() const { return indices_; }
+  //////////////////////////////////////////////////////////////////////////////
+  /// private members
+  //////////////////////////////////////////////////////////////////////////////
+ private:
+  /**
+   * \brief Appends the cluster of indices_[begin], ..., indices_[end - 1] and
+   * recursively all its sons. Returns the index of the cluster.
+   */
+  int appendCluster(const Eigen::Matrix<double, Eigen::Dynamic, 3> &points,
+                    int begin, int end, int parent, int leaf_size) {
+    int id = clusters_.size();
+    clusters_.push_back(PointCluster());
+    PointCluster cluster;
+    cluster.begin_ = begin;
+    cluster.end_ = end;
+    cluster.parent_ = parent;
+    cluster.bbox_min_.setConstant(std::numeric_limits<double>::infinity());
+    cluster.bbox_max_.setConstant(-std::numeric_limits<double>::infinity());
+    for (auto i = begin; i < end; ++i) {
+      cluster.bbox_min_ =
+          cluster.bbox_min_.cwiseMin(points.row(indices_[i]).transpose());
+      cluster.bbox_max_ =
+          cluster.bbox_max_.cwiseMax(points.row(indices_[i]).transpose());
+    }
+    cluster.midpoint_ = 0.5 * (cluster.bbox_min_ + cluster.bbox_max_);
+    cluster.radius_ = 0.5 * (cluster.bbox_max_ - cluster.bbox_min_).norm();
+    if (end - begin > leaf_size && cluster.radius_ > 0) {
+      // bisect along the longest side of the bounding box
+      int dir;
+      (cluster.bbox_max_ - cluster.bbox_min_).maxCoeff(&dir);
+      int mid = begin + (end - begin) / 2;
+      std::nth_element(indices_.begin() + begin, indices_.begin() + mid,
+                       indices_.begin() + end, [&points, dir](int a, int b) {
+                         return points(a, dir) < points(b, dir);
+                       });
+      cluster.sons_.push_back(
+          appendCluster(points, begin, mid, id, leaf_size));
+      cluster.sons_.push_back(appendCluster(points, mid, end, id, leaf_size));
+    }
+    clusters_[id] = cluster;
+    return id;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// member variables
+  //////////////////////////////////////////////////////////////////////////////
+  std::vector<PointCluster> clusters_;
+  std::vector<int> indices_;
+};
+}  // namespace Bembel
+#endif  // BEMBEL_SRC_CLUSTERTREE_POINTCLUSTERTREE_HPP_
@@ -0,0 +1,151 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+#ifndef BEMBEL_SRC_CLUSTERTREE_QUADRATUREGEOMETRYCACHE_HPP_
+#define BEMBEL_SRC_CLUSTERTREE_QUADRATUREGEOMETRYCACHE_HPP_
+
+namespace Bembel {
+/**
+ *  \ingroup ClusterTree
+ *  \brief Memoizes the quadrature points of a cubature rule mapped to all
+ *  elements of an ElementTree.
+ *
+ *  The first request of a rule maps its points to the surface on all
+ *  elements, subsequent requests of the same rule return the stored surface
+ *  points. Thus, discrete operators, H2-matrices, linear forms and potentials
+ *  on the same mesh evaluate the geometry only once per rule. Rules are
+ *  identified by their points and weights. All methods are thread-safe.
+ *
+ *  The surface points are stored in the format of SuperSpace::map2surface
+ *  with the quadrature weights scaled by the mesh width of the element, i.e.,
+ *  in the format used for the far-field quadrature of the DuffyTrick. As in
+ *  SuperSpace::map2surface, the BezierElements are used on the elements of
+ *  the finest level if they are provided.
+ */
+class QuadratureGeometryCache {
+ public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// constructors
+  //////////////////////////////////////////////////////////////////////////////
+  QuadratureGeometryCache() {}
+  QuadratureGeometryCache(const QuadratureGeometryCache &) = delete;
+  QuadratureGeometryCache &operator=(const QuadratureGeometryCache &) = delete;
+  //////////////////////////////////////////////////////////////////////////////
+  /// methods
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Returns the points of the rule Q mapped to all elements of the
+   * element tree, indexed by the element id. The points are computed on the
+   * first request of the rule. Concurrent requests of the same rule wait for
+   * this computation, while requests of other rules proceed.
+   *
+   * \param element_tree The ElementTree the cache belongs to.
+   * \param bezier_elements The BezierElements of the leaves indexed by the
+   * element id, or nullptr if the patches are evaluated instead.
+   * \param Q Cubature rule on the unit square.
+   */
+  template <typename Cubature>
+  std::shared_ptr<const std::vector<ElementSurfacePoints>> get_surface_points(
+      const ElementTree &element_tree,
+      const std::vector<BezierElement> *bezier_elements, const Cubature &Q) {
+    std::promise<SurfacePointsPtr> promise;
+    Rule rule;
+    bool compute = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (const auto &stored : rules_)
+        if (stored.w_.size() == Q.w_.size() && stored.w_ == Q.w_ &&
+            stored.xi_ == Q.xi_)
+          rule = stored;
+      if (!rule.points_.valid()) {
+        rule.xi_ = Q.xi_;
+        rule.w_ = Q.w_;
+        rule.points_ = promise.get_future().share();
+        rules_.push_back(rule);
+        compute = true;
+      }
+    }
+    // the first request computes the points outside of the lock
+    if (compute)
+      promise.set_value(
+          computeSurfacePoints(element_tree, bezier_elements, rule));
+    return rule.points_.get();
+  }
+  /**
+   * \brief Releases all stored surface points. Surface points which are
+   * still in use elsewhere stay valid.
+   */
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rules_.clear();
+    return;
+  }
+  /**
+   * \brief Returns the number of rules for which surface points are stored.
+   */
+  int get_number_of_rules() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rules_.size();
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// private members
+  //////////////////////////////////////////////////////////////////////////////
+ private:
+  typedef std::shared_ptr<const std::vector<ElementSurfacePoints>>
+      SurfacePointsPtr;
+  struct Rule {
+    Eigen::Matrix<double, 2, Eigen::Dynamic> xi_;
+    Eigen::VectorXd w_;
+    std::shared_future<SurfacePointsPtr> points_;
+  };
+  /**
+   * \brief Maps the points of the rule to all elements in parallel.
+   */
+  SurfacePointsPtr computeSurfacePoints(
+      const ElementTree &element_tree,
+      const std::vector<BezierElement> *bezier_elements,
+      const Rule &rule) const {
+    const PatchVector &geometry = element_tree.get_geometry();
+    std::vector<const ElementTreeNode *> elements;
+    for (auto element = element_tree.cpbegin();
+         element != element_tree.cpend(); ++element)
+      elements.push_back(std::addressof(*element));
+    auto points = std::make_shared<std::vector<ElementSurfacePoints>>(
+        elements.size(), ElementSurfacePoints(rule.w_.size()));
+#pragma omp parallel for
+    for (auto e = 0; e < static_cast<int>(elements.size()); ++e) {
+      const ElementTreeNode &element = *elements[e];
+      ElementSurfacePoints &element_points = (*points)[element.id_];
+      if (bezier_elements != nullptr &&
+          element.level_ == element_tree.get_max_level()) {
+        const BezierElement &bezier_element = (*bezier_elements)[element.id_];
+        for (auto k = 0; k < rule.w_.size(); ++k)
+          bezier_element.updateSurfacePoint(std::addressof(element_points[k]),
+                                            rule.xi_.col(k),
+                                            element.get_h() * rule.w_(k));
+        continue;
+      }
+      Eigen::Matrix<double, 2, Eigen::Dynamic> ref_pts =
+          element.get_h() * rule.xi_;
+      ref_pts.colwise() += element.llc_;
+      geometry[element.patch_].updateSurfacePoints(
+          &element_points, ref_pts, element.get_h() * rule.w_, rule.xi_);
+    }
+    return points;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// member variables
+  //////////////////////////////////////////////////////////////////////////////
+  mutable std::mutex mutex_;
+  std::vector<Rule> rules_;
+};
+}  // namespace Bembel
+#endif  // BEMBEL_SRC_CLUSTERTREE_QUADRATUREGEOMETRYCACHE_HPP_
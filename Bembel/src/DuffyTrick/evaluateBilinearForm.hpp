@@ -15,33 +15,24 @@ namespace Bembel {
 namespace DuffyTrick {
 /**
  * \ingroup DuffyTrick
- * \brief This function wraps the quadrature routines for the DuffyTrick and
- *returns all integrals for the given pair of elements.
+ * \brief Integrates a pair of elements related as described by the output cp
+ * of compareElements with the cubature rule Q.
+ *
+ * For distinct elements, the precomputed far-field quadrature nodes are used
+ * if farfield is true.
  */
-template <typename Derived, class T, class CubatureVector>
-void evaluateBilinearForm(
+template <typename Derived, class T>
+void integrateElementPair(
     const LinearOperatorBase<Derived>& linOp, const T& super_space,
     const ElementTreeNode& e1, const ElementTreeNode& e2,
-    const CubatureVector& GS, const ElementSurfacePoints& ffield_qnodes1,
+    const Eigen::Vector3i& cp, const Cubature& Q, bool farfield,
+    const ElementSurfacePoints& ffield_qnodes1,
     const ElementSurfacePoints& ffield_qnodes2,
     Eigen::Matrix<typename LinearOperatorTraits<Derived>::Scalar,
                   Eigen::Dynamic, Eigen::Dynamic>* intval) {
-  //////////////////////////////////////////////////////////////////////////////
-  double dist = 0;
-  int ffield_deg =
-      linOp.get_FarfieldQuadratureDegree(super_space.get_polynomial_degree());
-  int nfield_deg = 0;
-  auto cp = compareElements(e1, e2, &dist);
-  nfield_deg = linOp.getNearfieldQuadratureDegree(
-      super_space.get_polynomial_degree(), dist, e1.level_);
-  // make sure that the quadratur degree is at least the far field degree
-  nfield_deg = nfield_deg >= ffield_deg ? nfield_deg : ffield_deg;
-  assert(nfield_deg < Constants::maximum_quadrature_degree &&
-         "nfield_deg too large, increase maximum_quadrature_degree");
-  auto Q = GS[nfield_deg];
   switch (cp(2)) {
     case 0:
-      if (nfield_deg == ffield_deg) {
+      if (farfield) {
         integrate0(linOp, super_space, e1, 0, e2, 0, ffield_qnodes1,
                    ffield_qnodes2, Q, intval);
         return;
@@ -69,6 +60,176 @@ void evaluateBilinearForm(
   }
   return;
 }
+/**
+ * \ingroup DuffyTrick
+ * \brief Returns the class of a pair of elements for the adaptive near-field
+ * quadrature, see NearfieldQuadratureDegrees.
+ *
+ * Distinct elements are grouped by the binary logarithm of their distance
+ * relative to the mesh width, elements with a common edge or vertex by the
+ * type of the singularity only.
+ */
+inline NearfieldQuadratureDegrees::Key nearfieldQuadratureClass(
+    const Eigen::Vector3i& cp, double dist, int level, int polynomial_degree) {
+  // relative distances below 2^-16 share the lowest class
+  int distance_class = -16;
+  if (cp(2) == 0 && dist * (1 << level) > std::ldexp(1., -16))
+    distance_class = std::floor(std::log2(dist * (1 << level)));
+  NearfieldQuadratureDegrees::Key key = {
+      {cp(2), level, distance_class, polynomial_degree}};
+  return key;
+}
+/**
+ * \ingroup DuffyTrick
+ * \brief Determines the near-field quadrature degree for a pair of elements
+ * and returns it. The degree is increased, starting from the far-field
+ * degree, until the element matrices of two consecutive degrees differ by less
+ * than the tolerance relative to their largest entry. On return, intval
+ * contains the result of the higher degree, which was used for the estimate.
+ */
+template <typename Derived, class T, class CubatureVector>
+int computeNearfieldQuadratureDegree(
+    const LinearOperatorBase<Derived>& linOp, const T& super_space,
+    const ElementTreeNode& e1, const ElementTreeNode& e2,
+    const Eigen::Vector3i& cp, const CubatureVector& GS,
+    const ElementSurfacePoints& ffield_qnodes1,
+    const ElementSurfacePoints& ffield_qnodes2,
+    Eigen::Matrix<typename LinearOperatorTraits<Derived>::Scalar,
+                  Eigen::Dynamic, Eigen::Dynamic>* intval) {
+  const double tolerance = linOp.get_nearfield_quadrature_tolerance();
+  int nfield_deg =
+      linOp.get_FarfieldQuadratureDegree(super_space.get_polynomial_degree());
+  integrateElementPair(linOp, super_space, e1, e2, cp, GS[nfield_deg], true,
+                       ffield_qnodes1, ffield_qnodes2, intval);
+  Eigen::Matrix<typename LinearOperatorTraits<Derived>::Scalar, Eigen::Dynamic,
+                Eigen::Dynamic>
+      previous;
+  while (nfield_deg + 1 < Constants::maximum_quadrature_degree) {
+    previous.swap(*intval);
+    intval->resize(previous.rows(), previous.cols());
+    integrateElementPair(linOp, super_space, e1, e2, cp, GS[nfield_deg + 1],
+                         false, ffield_qnodes1, ffield_qnodes2, intval);
+    if ((*intval - previous).cwiseAbs().maxCoeff() <=
+        tolerance * intval->cwiseAbs().maxCoeff())
+      break;
+    ++nfield_deg;
+  }
+  return nfield_deg;
+}
+/**
+ * \ingroup DuffyTrick
+ * \brief Determines the near-field quadrature degrees of the adaptive
+ * quadrature for all classes of the given element pairs, see
+ * evaluateBilinearForm. This has to be done before the assembly.
+ *
+ * The degree of a class is determined on its pair with the lexicographically
+ * smallest element ids, such that it does not depend on the order of the
+ * pairs or on the scheduling of the assembly. Degrees which are already
+ * stored are kept. Since only one pair per class is integrated, the classes
+ * are processed serially. Nothing is done if the adaptive quadrature is
+ * disabled.
+ *
+ * \param pairs Element pairs which are integrated in the assembly.
+ * \param ffield_qnodes Far-field quadrature points indexed by the element id.
+ */
+template <typename Derived, class T, class CubatureVector>
+void computeNearfieldQuadratureDegrees(
+    const LinearOperatorBase<Derived>& linOp, const T& super_space,
+    const std::vector<std::pair<const ElementTreeNode*,
+                                const ElementTreeNode*>>& pairs,
+    const CubatureVector& GS,
+    const std::vector<ElementSurfacePoints>& ffield_qnodes) {
+  if (linOp.get_nearfield_quadrature_tolerance() <= 0) return;
+  NearfieldQuadratureDegrees& degrees =
+      linOp.get_nearfield_quadrature_degrees();
+  std::map<NearfieldQuadratureDegrees::Key,
+           std::pair<const ElementTreeNode*, const ElementTreeNode*>>
+      representatives;
+  for (const auto& pair : pairs) {
+    double dist = 0;
+    const Eigen::Vector3i cp =
+        compareElements(*pair.first, *pair.second, &dist);
+    const NearfieldQuadratureDegrees::Key key = nearfieldQuadratureClass(
+        cp, dist, pair.first->level_, super_space.get_polynomial_degree());
+    if (degrees.get_degree(key) >= 0) continue;
+    auto it = representatives.find(key);
+    if (it == representatives.end())
+      representatives[key] = pair;
+    else if (std::make_pair(pair.first->id_, pair.second->id_) <
+             std::make_pair(it->second.first->id_, it->second.second->id_))
+      it->second = pair;
+  }
+  const int polynomial_degree_plus_one_squared =
+      (super_space.get_polynomial_degree() + 1) *
+      (super_space.get_polynomial_degree() + 1);
+  const int size =
+      getFunctionSpaceVectorDimension<LinearOperatorTraits<Derived>::Form>() *
+      polynomial_degree_plus_one_squared;
+  Eigen::Matrix<typename LinearOperatorTraits<Derived>::Scalar, Eigen::Dynamic,
+                Eigen::Dynamic>
+      intval(size, size);
+  for (const auto& representative : representatives) {
+    const ElementTreeNode& e1 = *representative.second.first;
+    const ElementTreeNode& e2 = *representative.second.second;
+    double dist = 0;
+    const Eigen::Vector3i cp = compareElements(e1, e2, &dist);
+    degrees.set_degree(
+        representative.first,
+        computeNearfieldQuadratureDegree(linOp, super_space, e1, e2, cp, GS,
+                                         ffield_qnodes[e1.id_],
+                                         ffield_qnodes[e2.id_], &intval));
+  }
+  return;
+}
+/**
+ * \ingroup DuffyTrick
+ * \brief This function wraps the quadrature routines for the DuffyTrick and
+ *returns all integrals for the given pair of elements.
+ *
+ * If the linear operator has a positive near-field quadrature tolerance, the
+ * degree of the class of the pair is used, which has been determined by
+ * computeNearfieldQuadratureDegrees. Pairs of classes without a degree
+ * determine their degree on their own, without storing it.
+ */
+template <typename Derived, class T, class CubatureVector>
+void evaluateBilinearForm(
+    const LinearOperatorBase<Derived>& linOp, const T& super_space,
+    const ElementTreeNode& e1, const ElementTreeNode& e2,
+    const CubatureVector& GS, const ElementSurfacePoints& ffield_qnodes1,
+    const ElementSurfacePoints& ffield_qnodes2,
+    Eigen::Matrix<typename LinearOperatorTraits<Derived>::Scalar,
+                  Eigen::Dynamic, Eigen::Dynamic>* intval) {
+  //////////////////////////////////////////////////////////////////////////////
+  double dist = 0;
+  int ffield_deg =
+      linOp.get_FarfieldQuadratureDegree(super_space.get_polynomial_degree());
+  int nfield_deg = 0;
+  auto cp = compareElements(e1, e2, &dist);
+  if (linOp.get_nearfield_quadrature_tolerance() > 0) {
+    nfield_deg = linOp.get_nearfield_quadrature_degrees().get_degree(
+        nearfieldQuadratureClass(cp, dist, e1.level_,
+                                 super_space.get_polynomial_degree()));
+    if (nfield_deg < 0) {
+      computeNearfieldQuadratureDegree(linOp, super_space, e1, e2, cp, GS,
+                                       ffield_qnodes1, ffield_qnodes2, intval);
+      return;
+    }
+    integrateElementPair(linOp, super_space, e1, e2, cp, GS[nfield_deg],
+                         nfield_deg == ffield_deg, ffield_qnodes1,
+                         ffield_qnodes2, intval);
+    return;
+  }
+  nfield_deg = linOp.getNearfieldQuadratureDegree(
+      super_space.get_polynomial_degree(), dist, e1.level_);
+  // make sure that the quadratur degree is at least the far field degree
+  nfield_deg = nfield_deg >= ffield_deg ? nfield_deg : ffield_deg;
+  assert(nfield_deg < Constants::maximum_quadrature_degree &&
+         "nfield_deg too large, increase maximum_quadrature_degree");
+  integrateElementPair(linOp, super_space, e1, e2, cp, GS[nfield_deg],
+                       nfield_deg == ffield_deg, ffield_qnodes1,
+                       ffield_qnodes2, intval);
+  return;
+}
 }  // namespace DuffyTrick
 }  // namespace Bembel
 #endif  // BEMBEL_SRC_DUFFYTRICK_EVALUATEBILINEARFORM_HPP_
@@ -17,32 +17,18 @@ namespace DuffyTrick {
 /**
  * \ingroup DuffyTrick
  * \brief evaluates a given quadrature on all surface panels storage format is
- *qNodes.col(k) = [xi, w, Chi(xi); dsChi(xi); dtChi(xi)]
+ *qNodes.col(k) = [xi, w, Chi(xi); dsChi(xi); dtChi(xi)]. Operators should
+ *prefer ClusterTree::get_quadrature_points, which avoids the copy.
  */
 template <class T>
 std::vector<ElementSurfacePoints> computeFfieldQnodes(const T &super_space,
                                                       const Cubature &Q) {
-  std::vector<ElementSurfacePoints> ffield_qnodes;
-  int next = 0;
-  // assume isotropic mesh width h!
-  double h = (super_space.get_mesh().get_element_tree().cpbegin())->get_h();
-  auto nE = super_space.get_mesh().get_number_of_elements();
-  auto pbegin = super_space.get_mesh().get_element_tree().cpbegin();
-  auto pend = super_space.get_mesh().get_element_tree().cpend();
-  ffield_qnodes.reserve(nE);
-  SurfacePoint surfpt;
-
-  for (auto it = pbegin; it != pend; ++it) {
-    ffield_qnodes.emplace_back(Q.xi_.cols());
-    for (auto k = 0; k < Q.xi_.cols(); ++k) {
-      // the quadrature weight is scaled by mesh width
-      // this corresponds to a scaling of the basis functions
-      // with respect to the L^2 norm!
-      super_space.map2surface(*it, Q.xi_.col(k), h * Q.w_(k),
-                              &ffield_qnodes[it->id_][k]);
-    }
-  }
-  return ffield_qnodes;
+  // the quadrature weight is scaled by mesh width
+  // this corresponds to a scaling of the basis functions
+  // with respect to the L^2 norm!
+  // the surface points are taken from the cache of the mesh, such that the
+  // geometry is only evaluated once per quadrature rule
+  return *(super_space.get_mesh().get_quadrature_points(Q));
 }
 }  // namespace DuffyTrick
 }  // namespace Bembel
@@ -0,0 +1,288 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+#ifndef BEMBEL_SRC_GEOMETRY_BEZIERELEMENT_HPP_
+#define BEMBEL_SRC_GEOMETRY_BEZIERELEMENT_HPP_
+namespace Bembel {
+
+/**
+ * \ingroup Geometry
+ * \class BezierElement
+ * \brief Rational Bezier representation of a patch restricted to an element.
+ *
+ * An element \f$[a,a+h]\times[b,b+h]\f$ of a uniform refinement typically lies
+ * within a single knot span of its patch. The restriction of the patch is
+ * therefore a rational Bezier surface, whose control net is computed once by
+ * solving the same interpolation problem as the Bezier extraction. Evaluations
+ * are then carried out with respect to the local coordinates of the element
+ * and do not require a lookup in the knot vectors. If interior knots of the
+ * patch cut the element, it is split along these knots into several rational
+ * Bezier pieces, each of which has its own control net.
+ */
+class BezierElement {
+ public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// constructors
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Default constructor.
+   */
+  BezierElement()
+      : breaks_x_({0., 1.}),
+        breaks_y_({0., 1.}),
+        polynomial_degree_x_(0),
+        polynomial_degree_y_(0),
+        h_(1) {}
+  /**
+   * \brief Extracts the control net of the patch on the element with lower
+   * left corner llc and width h.
+   *
+   * \param patch The patch the element belongs to.
+   * \param llc Lower left corner of the element in the reference domain.
+   * \param h Width of the element in the reference domain.
+   */
+  BezierElement(const Patch &patch, const Eigen::Vector2d &llc, double h) {
+    init_BezierElement(patch, llc, h);
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// init
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Extracts the control net of the patch on the element with lower
+   * left corner llc and width h. The element is split along the interior
+   * knots of the patch which cut it.
+   *
+   * \param patch The patch the element belongs to.
+   * \param llc Lower left corner of the element in the reference domain.
+   * \param h Width of the element in the reference domain.
+   */
+  void init_BezierElement(const Patch &patch, const Eigen::Vector2d &llc,
+                          double h) {
+    polynomial_degree_x_ = patch.polynomial_degree_x_;
+    polynomial_degree_y_ = patch.polynomial_degree_y_;
+    h_ = h;
+    breaks_x_ = computeBreaks(patch.unique_knots_x_, llc(0), h);
+    breaks_y_ = computeBreaks(patch.unique_knots_y_, llc(1), h);
+    const int numy =
+        (patch.unique_knots_y_.size() - 1) * patch.polynomial_degree_y_;
+    const int net_size = 4 * polynomial_degree_x_ * polynomial_degree_y_;
+    const int pieces_x = breaks_x_.size() - 1;
+    const int pieces_y = breaks_y_.size() - 1;
+    data_.resize(pieces_x * pieces_y * net_size);
+    Eigen::MatrixXd net(polynomial_degree_x_, polynomial_degree_y_);
+    for (int px = 0; px < pieces_x; ++px) {
+      // the piece [c, c + d] of the element in x-direction and its knot span
+      const double cx = llc(0) + h * breaks_x_[px];
+      const double dx = h * (breaks_x_[px + 1] - breaks_x_[px]);
+      const int x_location = Spl::FindLocationInKnotVector(
+          cx + .5 * dx, patch.unique_knots_x_);
+      const Eigen::MatrixXd restriction_x = computeRestriction(
+          polynomial_degree_x_, patch.unique_knots_x_[x_location],
+          patch.unique_knots_x_[x_location + 1], cx, dx);
+      for (int py = 0; py < pieces_y; ++py) {
+        const double cy = llc(1) + h * breaks_y_[py];
+        const double dy = h * (breaks_y_[py + 1] - breaks_y_[py]);
+        const int y_location = Spl::FindLocationInKnotVector(
+            cy + .5 * dy, patch.unique_knots_y_);
+        const Eigen::MatrixXd restriction_y = computeRestriction(
+            polynomial_degree_y_, patch.unique_knots_y_[y_location],
+            patch.unique_knots_y_[y_location + 1], cy, dy);
+        double *piece = data_.data() + (px * pieces_y + py) * net_size;
+        const double *patch_net =
+            patch.data_.data() +
+            4 * (numy * polynomial_degree_x_ * x_location +
+                 polynomial_degree_y_ * y_location);
+        for (int k = 0; k < 4; ++k) {
+          for (int i = 0; i < polynomial_degree_x_; ++i)
+            for (int j = 0; j < polynomial_degree_y_; ++j)
+              net(i, j) = patch_net[4 * (numy * i + j) + k];
+          const Eigen::MatrixXd local_net =
+              restriction_x * net * restriction_y.transpose();
+          for (int i = 0; i < polynomial_degree_x_; ++i)
+            for (int j = 0; j < polynomial_degree_y_; ++j)
+              piece[4 * (i * polynomial_degree_y_ + j) + k] = local_net(i, j);
+        }
+      }
+    }
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// methods
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Evaluate the element at given point.
+   *
+   * \param xi Point in reference domain of the element.
+   * \return Point in physical domain.
+   */
+  Eigen::Vector3d eval(const Eigen::Vector2d &xi) const {
+    SurfacePoint srf_pt;
+    updateSurfacePoint(&srf_pt, xi, 1.);
+    return srf_pt.segment<3>(3);
+  }
+  /**
+   * \brief Evaluate Jacobian of the parametrization of the patch at given
+   * point, i.e., with respect to the reference domain of the patch.
+   *
+   * \param xi Point in reference domain of the element.
+   * \return 3x2 Matrix with the Jacobian.
+   */
+  Eigen::Matrix<double, 3, 2> evalJacobian(const Eigen::Vector2d &xi) const {
+    SurfacePoint srf_pt;
+    updateSurfacePoint(&srf_pt, xi, 1.);
+    Eigen::Matrix<double, 3, 2> out;
+    out.col(0) = srf_pt.segment<3>(6);
+    out.col(1) = srf_pt.segment<3>(9);
+    return out;
+  }
+  /**
+   * \brief Updates the surface point in the same way as
+   * Patch::updateSurfacePoint, where the reference point with respect to the
+   * patch is the image of xi under the affine map of the element.
+   *
+   * \param srf_pt Pointer to the SurfacePoint which gets updated.
+   * \param xi Point in reference domain with respect to the element.
+   * \param w quadrature weight.
+   */
+  void updateSurfacePoint(SurfacePoint *srf_pt, const Eigen::Vector2d &xi,
+                          double w) const {
+    // locate the Bezier piece of the element and the local coordinates in it
+    const int pieces_x = breaks_x_.size() - 1;
+    const int pieces_y = breaks_y_.size() - 1;
+    int px = 0;
+    int py = 0;
+    while (px + 1 < pieces_x && xi(0) >= breaks_x_[px + 1]) ++px;
+    while (py + 1 < pieces_y && xi(1) >= breaks_y_[py + 1]) ++py;
+    const double dx = breaks_x_[px + 1] - breaks_x_[px];
+    const double dy = breaks_y_[py + 1] - breaks_y_[py];
+    const double tx = (xi(0) - breaks_x_[px]) / dx;
+    const double ty = (xi(1) - breaks_y_[py]) / dy;
+    const double *net = data_.data() + (px * pieces_y + py) * 4 *
+                                           polynomial_degree_x_ *
+                                           polynomial_degree_y_;
+
+    double xbasis[Constants::MaxP + 1];
+    double ybasis[Constants::MaxP + 1];
+    double xbasisD[Constants::MaxP + 1];
+    double ybasisD[Constants::MaxP + 1];
+    Bembel::Basis::ShapeFunctionHandler::evalBasis(polynomial_degree_x_ - 1,
+                                                   xbasis, tx);
+    Bembel::Basis::ShapeFunctionHandler::evalBasis(polynomial_degree_y_ - 1,
+                                                   ybasis, ty);
+    Bembel::Basis::ShapeFunctionHandler::evalDerBasis(polynomial_degree_x_ - 1,
+                                                      xbasisD, tx);
+    Bembel::Basis::ShapeFunctionHandler::evalDerBasis(polynomial_degree_y_ - 1,
+                                                      ybasisD, ty);
+
+    double tmp[4] = {0., 0., 0., 0.};
+    double tmpDx[4] = {0., 0., 0., 0.};
+    double tmpDy[4] = {0., 0., 0., 0.};
+    for (int i = 0; i < polynomial_degree_x_; ++i) {
+      for (int j = 0; j < polynomial_degree_y_; ++j) {
+        const double tpbasisval = xbasis[i] * ybasis[j];
+        const double tpbasisvalDx = xbasisD[i] * ybasis[j];
+        const double tpbasisvalDy = xbasis[i] * ybasisD[j];
+        const double *coefficients =
+            net + 4 * (i * polynomial_degree_y_ + j);
+#pragma omp simd
+        for (int k = 0; k < 4; ++k) {
+          tmp[k] += coefficients[k] * tpbasisval;
+          tmpDx[k] += coefficients[k] * tpbasisvalDx;
+          tmpDy[k] += coefficients[k] * tpbasisvalDy;
+        }
+      }
+    }
+
+    // the derivatives are taken with respect to the reference domain of the
+    // patch, which is h times larger than the one of the element, and the
+    // pieces cover the fractions dx and dy of the element
+    const double bot = 1. / tmp[3];
+    const double botsqrx = bot * bot / (h_ * dx);
+    const double botsqry = bot * bot / (h_ * dy);
+
+    (*srf_pt)(0) = xi(0);
+    (*srf_pt)(1) = xi(1);
+    (*srf_pt)(2) = w;
+    (*srf_pt)(3) = tmp[0] * bot;
+    (*srf_pt)(4) = tmp[1] * bot;
+    (*srf_pt)(5) = tmp[2] * bot;
+    (*srf_pt)(6) = (tmpDx[0] * tmp[3] - tmp[0] * tmpDx[3]) * botsqrx;
+    (*srf_pt)(7) = (tmpDx[1] * tmp[3] - tmp[1] * tmpDx[3]) * botsqrx;
+    (*srf_pt)(8) = (tmpDx[2] * tmp[3] - tmp[2] * tmpDx[3]) * botsqrx;
+    (*srf_pt)(9) = (tmpDy[0] * tmp[3] - tmp[0] * tmpDy[3]) * botsqry;
+    (*srf_pt)(10) = (tmpDy[1] * tmp[3] - tmp[1] * tmpDy[3]) * botsqry;
+    (*srf_pt)(11) = (tmpDy[2] * tmp[3] - tmp[2] * tmpDy[3]) * botsqry;
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// getter
+  //////////////////////////////////////////////////////////////////////////////
+  int get_polynomial_degree_x() const { return polynomial_degree_x_; }
+  int get_polynomial_degree_y() const { return polynomial_degree_y_; }
+  /**
+   * \brief Returns the control nets of all Bezier pieces of the element, one
+   * after another in the format of Patch::data_.
+   */
+  const std::vector<double> &get_data() const { return data_; }
+  /**
+   * \brief Returns the number of Bezier pieces, which is larger than one if
+   * interior knots of the patch cut the element.
+   */
+  int get_number_of_pieces() const {
+    return (breaks_x_.size() - 1) * (breaks_y_.size() - 1);
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// private members
+  //////////////////////////////////////////////////////////////////////////////
+ private:
+  /**
+   * \brief Returns the break points of the element [c,c+h] in its local
+   * coordinates, i.e., 0, the images of the knots inside the element, and 1.
+   */
+  static std::vector<double> computeBreaks(const std::vector<double> &knots,
+                                           double c, double h) {
+    std::vector<double> breaks(1, 0.);
+    for (auto knot : knots)
+      if (knot > c + Constants::pt_comp_tolerance &&
+          knot < c + h - Constants::pt_comp_tolerance)
+        breaks.push_back((knot - c) / h);
+    breaks.push_back(1.);
+    return breaks;
+  }
+  /**
+   * \brief Returns the matrix which maps the Bernstein coefficients on the
+   * knot span [a,b] to the ones on the subinterval [c,c+h].
+   *
+   * The polynomial is interpolated in the points of MakeInterpolationMask on
+   * the subinterval, as in the Bezier extraction.
+   */
+  static Eigen::MatrixXd computeRestriction(int polynomial_degree, double a,
+                                            double b, double c, double h) {
+    const std::vector<double> mask =
+        Spl::MakeInterpolationMask(polynomial_degree);
+    Eigen::MatrixXd values(polynomial_degree, polynomial_degree);
+    double val[Constants::MaxP + 1];
+    for (int i = 0; i < polynomial_degree; ++i) {
+      Bembel::Basis::ShapeFunctionHandler::evalBasis(
+          polynomial_degree - 1, val, Spl::Rescale(c + h * mask[i], a, b));
+      for (int j = 0; j < polynomial_degree; ++j) values(i, j) = val[j];
+    }
+    return Spl::GetInterpolationMatrix(polynomial_degree - 1, mask) * values;
+  }
+
+  std::vector<double> data_;  // Control nets in the format of Patch::data_
+  std::vector<double> breaks_x_;  // Break points of the pieces in x
+  std::vector<double> breaks_y_;  // Break points of the pieces in y
+  int polynomial_degree_x_;       // Degree in x
+  int polynomial_degree_y_;       // Degree in y
+  double h_;                      // Width of the element
+};
+}  // namespace Bembel
+#endif  // BEMBEL_SRC_GEOMETRY_BEZIERELEMENT_HPP_
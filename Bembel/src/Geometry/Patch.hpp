@@ -363,6 +363,184 @@ class Patch {
     delete[] buffer;
     return;
   }
+  /**
+   * \brief Evaluates the patch and its Jacobian at several points in the
+   * reference domain, typically the quadrature points of an element.
+   *
+   * The knot span is looked up for every point and the sums over the control
+   * points are carried out for all points within the same Bezier element at
+   * once. The results are returned column-wise, i.e., each coordinate is
+   * stored contiguously for all points.
+   *
+   * \param reference_points 2xN matrix of points in the reference domain.
+   * \param points Nx3 matrix with the points in the physical domain.
+   * \param jacobians Nx6 matrix, whose first three columns contain the
+   * derivatives with respect to x and whose last three columns contain the
+   * derivatives with respect to y. May be nullptr if not required.
+   */
+  void evalBatch(
+      const Eigen::Matrix<double, 2, Eigen::Dynamic> &reference_points,
+      Eigen::Matrix<double, Eigen::Dynamic, 3> *points,
+      Eigen::Matrix<double, Eigen::Dynamic, 6> *jacobians = nullptr) const {
+    const int number_of_points = reference_points.cols();
+    std::vector<std::pair<int, int>> locations(number_of_points);
+    bool single_span = true;
+    for (int p = 0; p < number_of_points; ++p) {
+      locations[p].first = Spl::FindLocationInKnotVector(
+          reference_points(0, p), unique_knots_x_);
+      locations[p].second = Spl::FindLocationInKnotVector(
+          reference_points(1, p), unique_knots_y_);
+      single_span = single_span && locations[p] == locations[0];
+    }
+    if (single_span) {
+      const std::pair<int, int> location =
+          number_of_points ? locations[0] : std::make_pair(0, 0);
+      evalBatchInSpan(reference_points, location.first, location.second,
+                      points, jacobians);
+      return;
+    }
+    // the points are spread over several Bezier elements, evaluate the
+    // points of each Bezier element at once
+    points->resize(number_of_points, 3);
+    if (jacobians != nullptr) jacobians->resize(number_of_points, 6);
+    std::map<std::pair<int, int>, std::vector<int>> groups;
+    for (int p = 0; p < number_of_points; ++p)
+      groups[locations[p]].push_back(p);
+    for (const auto &group : groups) {
+      const std::vector<int> &indices = group.second;
+      Eigen::Matrix<double, 2, Eigen::Dynamic> group_points(2, indices.size());
+      for (int p = 0; p < static_cast<int>(indices.size()); ++p)
+        group_points.col(p) = reference_points.col(indices[p]);
+      Eigen::Matrix<double, Eigen::Dynamic, 3> group_values;
+      Eigen::Matrix<double, Eigen::Dynamic, 6> group_jacobians;
+      evalBatchInSpan(group_points, group.first.first, group.first.second,
+                      &group_values,
+                      jacobians != nullptr ? &group_jacobians : nullptr);
+      for (int p = 0; p < static_cast<int>(indices.size()); ++p) {
+        points->row(indices[p]) = group_values.row(p);
+        if (jacobians != nullptr)
+          jacobians->row(indices[p]) = group_jacobians.row(p);
+      }
+    }
+    return;
+  }
+  /**
+   * \brief Evaluates the patch and its Jacobian at several points within
+   * the Bezier element with the given knot span indices, see evalBatch.
+   */
+  void evalBatchInSpan(
+      const Eigen::Matrix<double, 2, Eigen::Dynamic> &reference_points,
+      int x_location, int y_location,
+      Eigen::Matrix<double, Eigen::Dynamic, 3> *points,
+      Eigen::Matrix<double, Eigen::Dynamic, 6> *jacobians) const {
+    const int number_of_points = reference_points.cols();
+    const int numy = (unique_knots_y_.size() - 1) * polynomial_degree_y_;
+
+    // values of the 1D basis functions, the rows correspond to the points
+    Eigen::MatrixXd xbasis(number_of_points, polynomial_degree_x_);
+    Eigen::MatrixXd ybasis(number_of_points, polynomial_degree_y_);
+    Eigen::MatrixXd xbasisD(number_of_points, polynomial_degree_x_);
+    Eigen::MatrixXd ybasisD(number_of_points, polynomial_degree_y_);
+    Eigen::VectorXd xbuffer(polynomial_degree_x_);
+    Eigen::VectorXd ybuffer(polynomial_degree_y_);
+    for (int p = 0; p < number_of_points; ++p) {
+      const double scaledx =
+          Spl::Rescale(reference_points(0, p), unique_knots_x_[x_location],
+                       unique_knots_x_[x_location + 1]);
+      const double scaledy =
+          Spl::Rescale(reference_points(1, p), unique_knots_y_[y_location],
+                       unique_knots_y_[y_location + 1]);
+      Bembel::Basis::ShapeFunctionHandler::evalBasis(
+          polynomial_degree_x_ - 1, xbuffer.data(), scaledx);
+      xbasis.row(p) = xbuffer.transpose();
+      Bembel::Basis::ShapeFunctionHandler::evalBasis(
+          polynomial_degree_y_ - 1, ybuffer.data(), scaledy);
+      ybasis.row(p) = ybuffer.transpose();
+      if (jacobians != nullptr) {
+        Bembel::Basis::ShapeFunctionHandler::evalDerBasis(
+            polynomial_degree_x_ - 1, xbuffer.data(), scaledx);
+        xbasisD.row(p) = xbuffer.transpose();
+        Bembel::Basis::ShapeFunctionHandler::evalDerBasis(
+            polynomial_degree_y_ - 1, ybuffer.data(), scaledy);
+        ybasisD.row(p) = ybuffer.transpose();
+      }
+    }
+
+    // homogeneous coordinates and their derivatives for all points
+    Eigen::Matrix<double, Eigen::Dynamic, 4> tmp(number_of_points, 4);
+    Eigen::Matrix<double, Eigen::Dynamic, 4> tmpDx(number_of_points, 4);
+    Eigen::Matrix<double, Eigen::Dynamic, 4> tmpDy(number_of_points, 4);
+    tmp.setZero();
+    tmpDx.setZero();
+    tmpDy.setZero();
+    for (int i = 0; i < polynomial_degree_x_; ++i) {
+      for (int j = 0; j < polynomial_degree_y_; ++j) {
+        const int accs = 4 * (numy * (polynomial_degree_x_ * x_location + i) +
+                              polynomial_degree_y_ * y_location + j);
+        const Eigen::ArrayXd tpbasisval =
+            xbasis.col(i).array() * ybasis.col(j).array();
+        for (int k = 0; k < 4; ++k)
+          tmp.col(k).array() += data_[accs + k] * tpbasisval;
+        if (jacobians != nullptr) {
+          const Eigen::ArrayXd tpbasisvalDx =
+              xbasisD.col(i).array() * ybasis.col(j).array();
+          const Eigen::ArrayXd tpbasisvalDy =
+              xbasis.col(i).array() * ybasisD.col(j).array();
+          for (int k = 0; k < 4; ++k) {
+            tmpDx.col(k).array() += data_[accs + k] * tpbasisvalDx;
+            tmpDy.col(k).array() += data_[accs + k] * tpbasisvalDy;
+          }
+        }
+      }
+    }
+
+    // projection to 3D from 4D homogeneous coordinates
+    const Eigen::ArrayXd bot = tmp.col(3).array().inverse();
+    points->resize(number_of_points, 3);
+    for (int k = 0; k < 3; ++k) points->col(k) = tmp.col(k).array() * bot;
+    if (jacobians != nullptr) {
+      const Eigen::ArrayXd botsqr = bot * bot;
+      jacobians->resize(number_of_points, 6);
+      for (int k = 0; k < 3; ++k) {
+        jacobians->col(k) = (tmpDx.col(k).array() * tmp.col(3).array() -
+                             tmp.col(k).array() * tmpDx.col(3).array()) *
+                            botsqr;
+        jacobians->col(3 + k) = (tmpDy.col(k).array() * tmp.col(3).array() -
+                                 tmp.col(k).array() * tmpDy.col(3).array()) *
+                                botsqr;
+      }
+    }
+    return;
+  }
+  /**
+   * \brief Updates several surface points at once, see updateSurfacePoint
+   * and evalBatch.
+   *
+   * \param srf_pts The SurfacePoints which get updated.
+   * \param ref_pts 2xN matrix of points in reference domain with respect to
+   * the patch.
+   * \param w quadrature weights.
+   * \param xi 2xN matrix of points in reference domain with respect to the
+   * element.
+   */
+  void updateSurfacePoints(
+      ElementSurfacePoints *srf_pts,
+      const Eigen::Matrix<double, 2, Eigen::Dynamic> &ref_pts,
+      const Eigen::VectorXd &w,
+      const Eigen::Matrix<double, 2, Eigen::Dynamic> &xi) const {
+    Eigen::Matrix<double, Eigen::Dynamic, 3> points;
+    Eigen::Matrix<double, Eigen::Dynamic, 6> jacobians;
+    evalBatch(ref_pts, &points, &jacobians);
+    srf_pts->resize(ref_pts.cols());
+    for (int p = 0; p < ref_pts.cols(); ++p) {
+      SurfacePoint &srf_pt = (*srf_pts)[p];
+      srf_pt.head<2>() = xi.col(p);
+      srf_pt(2) = w(p);
+      srf_pt.segment<3>(3) = points.row(p).transpose();
+      srf_pt.segment<6>(6) = jacobians.row(p).transpose();
+    }
+    return;
+  }
 
   //////////////////////////////////////////////////////////////////////////////
   /// getter
@@ -20,11 +20,31 @@ struct BlockClusterAdmissibility {
   enum { Refine = 0, LowRank = 1, Dense = 2 };
 };
 
+/**
+ * \brief Storage modes of the dense near-field leaves of an H2Matrix.
+ *
+ * Stored leaves are assembled once, OnTheFly leaves only keep their cluster
+ * pair and are integrated again in each matrix-vector multiplication. Packed
+ * leaves are assembled once directly into a PackedNearfield, which is only
+ * available in double precision.
+ */
+struct H2NearfieldMode {
+  enum { Stored = 0, OnTheFly = 1, Packed = 2 };
+};
+/**
+ * \brief Storage precision of an H2Matrix. In single precision, the leafs
+ * and optionally the moment matrices are stored in float or complex<float>,
+ * while the matrix-vector multiplication still accumulates in the precision
+ * of the H2Matrix.
+ */
+struct H2StoragePrecision {
+  enum { Double = 0, Single = 1, SingleWithMoments = 2 };
+};
+
 template <typename Scalar>
 struct BlockClusterTreeParameters {
   BlockClusterTreeParameters()
       : eta_(-1), min_cluster_level_(-1), max_level_(-1) {}
-  GaussSquare<Constants::maximum_quadrature_degree> GS_;
   Eigen::Matrix<double, 12, Eigen::Dynamic> ffield_qnodes_;
   double eta_;             // eta from admissibility condition
   int ffield_deg_;         // todo @Michael comment this
@@ -26,6 +26,23 @@ template <typename H2LhsType, typename DenseRhsType, typename DenseResType,
                            DenseRhsType::ColsAtCompileTime == 1>
 struct H2_time_dense_product_impl;
 
+/**
+ * \brief Adds the product of the full matrix of a tree leaf with rhs to dst.
+ * Leafs stored in single precision are cast coefficient-wise, such that the
+ * accumulation takes place in the precision of the H2Matrix.
+ */
+template <typename ScalarH2, typename RhsType, typename DstType>
+inline void H2_leaf_time_dense_product(
+    const Bembel::TreeLeaf<Matrix<ScalarH2, Dynamic, Dynamic>>& leaf,
+    const MatrixBase<RhsType>& rhs, const MatrixBase<DstType>& dst) {
+  if (leaf.is_single_precision())
+    dst.const_cast_derived() +=
+        leaf.get_F_single().template cast<ScalarH2>().lazyProduct(rhs);
+  else
+    dst.const_cast_derived() += leaf.get_F_view() * rhs;
+  return;
+}
+
 /**
  * \brief H2-matrix-vector multiplication, works also for matrices by iterating
  * over the columns.
@@ -43,123 +60,210 @@ struct H2_time_dense_product_impl<H2Matrix<ScalarH2>, DenseRhsType,
         lhs.get_block_cluster_tree()(0, 0).get_parameters().max_level_;
     int min_cluster_level =
         lhs.get_block_cluster_tree()(0, 0).get_parameters().min_cluster_level_;
-    auto moment_matrix = lhs.get_fmm_moment_matrix();
-    auto transfer_matrices = lhs.get_fmm_transfer_matrices();
-    int vector_dimension = moment_matrix.size();
+    // the moment matrices are either stored in double or in single precision
+    const std::vector<MatrixXd>& moment_matrix = lhs.get_fmm_moment_matrix();
+    const std::vector<MatrixXf>& moment_matrix_single =
+        lhs.get_fmm_moment_matrix_single();
+    const bool single_moments = moment_matrix_single.size() > 0;
+    const MatrixXd& transfer_matrices = lhs.get_fmm_transfer_matrices();
+    int vector_dimension =
+        single_moments ? moment_matrix_single.size() : moment_matrix.size();
+
+    // the block-cluster trees of all vector components share the same
+    // structure, such that the k-th leaf of each tree belongs to the same
+    // pair of clusters
+    std::vector<typename std::vector<
+        Bembel::BlockClusterTree<ScalarH2>*>::const_iterator>
+        leafs(vector_dimension * vector_dimension);
+    for (int row_component = 0; row_component < vector_dimension;
+         ++row_component)
+      for (int col_component = 0; col_component < vector_dimension;
+           ++col_component)
+        leafs[row_component * vector_dimension + col_component] =
+            lhs.get_block_cluster_tree()(row_component, col_component)
+                .clbegin();
+    const bool on_the_fly =
+        lhs.get_nearfield_mode() == Bembel::H2NearfieldMode::OnTheFly;
+    const bool packed =
+        lhs.get_nearfield_mode() == Bembel::H2NearfieldMode::Packed;
+    const int number_of_leafs =
+        std::distance(lhs.get_block_cluster_tree()(0, 0).clbegin(),
+                      lhs.get_block_cluster_tree()(0, 0).clend());
+
+    // the structured transformation avoids the sparse products if it
+    // coincides with the transformation matrix and is faster
+    const Bembel::StructuredTransformation& structured_transformation =
+        lhs.get_structured_transformation();
+    const bool structured = structured_transformation.is_preferable();
 
     for (Index c = 0; c < rhs.cols(); ++c) {
       // go discontinuous in rhs
-      Matrix<ScalarH2, Dynamic, 1> long_rhs_all =
-          (lhs.get_transformation_matrix() * rhs.col(c)).eval();
+      Matrix<ScalarH2, Dynamic, 1> long_rhs_all;
+      if (structured)
+        structured_transformation.apply<ScalarH2>(rhs.col(c), &long_rhs_all);
+      else
+        long_rhs_all = lhs.get_transformation_matrix() * rhs.col(c);
       int vector_component_size = long_rhs_all.rows() / vector_dimension;
 
       // initialize destination
       Matrix<ScalarRes, Dynamic, 1> long_dst_all(long_rhs_all.rows());
       long_dst_all.setZero();
 
+      // do forward-transformation once for each vector component
+      std::vector<Matrix<ScalarRhs, Dynamic, 1>> long_rhs(vector_dimension);
+      std::vector<std::vector<Matrix<ScalarRhs, Dynamic, Dynamic>>>
+          long_rhs_forward(vector_dimension);
       for (int col_component = 0; col_component < vector_dimension;
            ++col_component) {
-        for (int row_component = 0; row_component < vector_dimension;
-             ++row_component) {
-          Matrix<ScalarRhs, Dynamic, 1> long_rhs = long_rhs_all.segment(
-              col_component * vector_component_size, vector_component_size);
-          Matrix<ScalarRhs, Dynamic, 1> long_dst(long_rhs.rows());
-          long_dst.setZero();
-
-          // split long rhs into pieces by reshaping
-          Matrix<ScalarRhs, Dynamic, Dynamic> long_rhs_matrix =
-              Map<Matrix<ScalarRhs, Dynamic, Dynamic>>(
-                  long_rhs.data(), moment_matrix[col_component].cols(),
-                  long_rhs.rows() / moment_matrix[col_component].cols());
-
-          // do forward-transformation
-          std::vector<Matrix<ScalarRhs, Dynamic, Dynamic>> long_rhs_forward =
-              Bembel::H2Multipole::forwardTransformation(
-                  moment_matrix[col_component], transfer_matrices,
-                  max_level - min_cluster_level, long_rhs_matrix);
+        long_rhs[col_component] = long_rhs_all.segment(
+            col_component * vector_component_size, vector_component_size);
+        // split long rhs into pieces by reshaping
+        const int moment_cols = single_moments
+                                    ? moment_matrix_single[col_component].cols()
+                                    : moment_matrix[col_component].cols();
+        Matrix<ScalarRhs, Dynamic, Dynamic> long_rhs_matrix =
+            Map<Matrix<ScalarRhs, Dynamic, Dynamic>>(
+                long_rhs[col_component].data(), moment_cols,
+                vector_component_size / moment_cols);
+        long_rhs_forward[col_component] =
+            single_moments
+                ? Bembel::H2Multipole::forwardTransformation(
+                      moment_matrix_single[col_component], transfer_matrices,
+                      max_level - min_cluster_level, long_rhs_matrix)
+                : Bembel::H2Multipole::forwardTransformation(
+                      moment_matrix[col_component], transfer_matrices,
+                      max_level - min_cluster_level, long_rhs_matrix);
+      }
 
 #pragma omp parallel
-          {
-            // initialize target for each process
-            Matrix<ScalarRes, Dynamic, 1> my_long_dst(long_dst.rows());
-
-            // initialize target of backward-transformation
-            std::vector<Matrix<ScalarRes, Dynamic, Dynamic>>
-                my_long_dst_backward;
-            for (int i = 0; i < long_rhs_forward.size(); ++i)
-              my_long_dst_backward.push_back(
-                  Matrix<ScalarRes, Dynamic, Dynamic>::Zero(
-                      long_rhs_forward[i].rows(), long_rhs_forward[i].cols()));
-            my_long_dst.setZero();
-
-            // matrix-vector
-            for (auto leaf =
-                     lhs.get_block_cluster_tree()(row_component, col_component)
-                         .clbegin();
-                 leaf !=
-                 lhs.get_block_cluster_tree()(row_component, col_component)
-                     .clend();
-                 ++leaf) {
+      {
+        // initialize target for each process
+        Matrix<ScalarRes, Dynamic, 1> my_long_dst(long_dst_all.rows());
+        my_long_dst.setZero();
+
+        // initialize targets of backward-transformation
+        std::vector<std::vector<Matrix<ScalarRes, Dynamic, Dynamic>>>
+            my_long_dst_backward(vector_dimension);
+        for (int row_component = 0; row_component < vector_dimension;
+             ++row_component)
+          for (int i = 0; i < long_rhs_forward[row_component].size(); ++i)
+            my_long_dst_backward[row_component].push_back(
+                Matrix<ScalarRes, Dynamic, Dynamic>::Zero(
+                    long_rhs_forward[row_component][i].rows(),
+                    long_rhs_forward[row_component][i].cols()));
+
+        // matrix-vector, all vector components of a leaf at once
+        for (int k = 0; k < number_of_leafs; ++k) {
 #pragma omp single nowait
-              {
-                switch ((*leaf)->get_cc()) {
-                  // deal with matrix blocks
-                  case Bembel::BlockClusterAdmissibility::Dense: {
-                    my_long_dst.segment((*leaf)->get_row_start_index(),
-                                        (*leaf)->get_row_end_index() -
-                                            (*leaf)->get_row_start_index()) +=
-                        (*leaf)->get_leaf().get_F() *
-                        long_rhs.segment((*leaf)->get_col_start_index(),
-                                         (*leaf)->get_col_end_index() -
-                                             (*leaf)->get_col_start_index());
-                  } break;
-                  // deal with low-rank blocks
-                  case Bembel::BlockClusterAdmissibility::LowRank: {
-                    const Bembel::ElementTreeNode* cluster1 =
-                        (*leaf)->get_cluster1();
-                    const Bembel::ElementTreeNode* cluster2 =
-                        (*leaf)->get_cluster2();
-                    int cluster_level = cluster1->get_level();
-                    int fmm_level = lhs.get_block_cluster_tree()(0, 0)
-                                        .get_parameters()
-                                        .max_level_ -
-                                    lhs.get_block_cluster_tree()(0, 0)
-                                        .get_parameters()
-                                        .min_cluster_level_ -
-                                    (*leaf)->get_cluster1()->get_level();
-                    int cluster1_col = cluster1->id_;
-                    int cluster2_col = cluster2->id_;
-                    my_long_dst_backward[fmm_level].col(cluster1_col) +=
-                        (*leaf)->get_leaf().get_F() *
-                        long_rhs_forward[fmm_level].col(cluster2_col);
-                  } break;
-                  // this leaf is not a low-rank block and not a dense block,
-                  // thus it is not a leaf -> error
-                  default:
-                    assert(0 && "This should never happen");
-                    break;
-                }
-              }
+          {
+            Bembel::BlockClusterTree<ScalarH2>* leaf = leafs[0][k];
+            switch (leaf->get_cc()) {
+              // deal with matrix blocks
+              case Bembel::BlockClusterAdmissibility::Dense: {
+                // packed leafs are dealt with below
+                if (packed) break;
+                int row_start = leaf->get_row_start_index();
+                int row_size = leaf->get_row_end_index() - row_start;
+                int col_start = leaf->get_col_start_index();
+                int col_size = leaf->get_col_end_index() - col_start;
+                // leafs which are not stored are integrated on the fly
+                std::vector<Matrix<ScalarH2, Dynamic, Dynamic>> F;
+                if (on_the_fly)
+                  F = lhs.computeNearfieldLeaf(*(leaf->get_cluster1()),
+                                               *(leaf->get_cluster2()));
+                for (int row_component = 0; row_component < vector_dimension;
+                     ++row_component)
+                  for (int col_component = 0; col_component < vector_dimension;
+                       ++col_component)
+                    if (on_the_fly)
+                      my_long_dst.segment(
+                          row_component * vector_component_size + row_start,
+                          row_size) +=
+                          F[col_component * vector_dimension + row_component] *
+                          long_rhs[col_component].segment(col_start, col_size);
+                    else
+                      H2_leaf_time_dense_product(
+                          leafs[row_component * vector_dimension +
+                                col_component][k]
+                              ->get_leaf(),
+                          long_rhs[col_component].segment(col_start, col_size),
+                          my_long_dst.segment(
+                              row_component * vector_component_size + row_start,
+                              row_size));
+              } break;
+              // deal with low-rank blocks
+              case Bembel::BlockClusterAdmissibility::LowRank: {
+                int fmm_level = max_level - min_cluster_level -
+                                leaf->get_cluster1()->get_level();
+                int cluster1_col = leaf->get_cluster1()->id_;
+                int cluster2_col = leaf->get_cluster2()->id_;
+                for (int row_component = 0; row_component < vector_dimension;
+                     ++row_component)
+                  for (int col_component = 0; col_component < vector_dimension;
+                       ++col_component)
+                    H2_leaf_time_dense_product(
+                        leafs[row_component * vector_dimension +
+                              col_component][k]
+                            ->get_leaf(),
+                        long_rhs_forward[col_component][fmm_level].col(
+                            cluster2_col),
+                        my_long_dst_backward[row_component][fmm_level].col(
+                            cluster1_col));
+              } break;
+              // this leaf is not a low-rank block and not a dense block,
+              // thus it is not a leaf -> error
+              default:
+                assert(0 && "This should never happen");
+                break;
             }
+          }
+        }
 
-            // do backward transformation
-            my_long_dst += Bembel::H2Multipole::backwardTransformation(
-                moment_matrix[row_component], transfer_matrices,
-                max_level - min_cluster_level, my_long_dst_backward);
+        // stream through the block rows of the packed near-field
+        if (packed)
+          for (int row_component = 0; row_component < vector_dimension;
+               ++row_component)
+            for (int col_component = 0; col_component < vector_dimension;
+                 ++col_component) {
+              const Bembel::PackedNearfield<ScalarH2>& nearfield =
+                  lhs.get_packed_nearfield()(row_component, col_component);
+              auto my_long_dst_component = my_long_dst.segment(
+                  row_component * vector_component_size, vector_component_size);
+#pragma omp for schedule(dynamic) nowait
+              for (int i = 0; i < nearfield.get_number_of_block_rows(); ++i)
+                nearfield.applyBlockRow(i, long_rhs[col_component],
+                                        &my_long_dst_component);
+            }
 
-#pragma omp critical
-            long_dst += my_long_dst;
-          }
+        // do backward transformation once for each vector component
+        for (int row_component = 0; row_component < vector_dimension;
+             ++row_component)
+          my_long_dst.segment(row_component * vector_component_size,
+                              vector_component_size) +=
+              (single_moments
+                   ? Bembel::H2Multipole::backwardTransformation(
+                         moment_matrix_single[row_component], transfer_matrices,
+                         max_level - min_cluster_level,
+                         my_long_dst_backward[row_component])
+                   : Bembel::H2Multipole::backwardTransformation(
+                         moment_matrix[row_component], transfer_matrices,
+                         max_level - min_cluster_level,
+                         my_long_dst_backward[row_component]));
 
-          // finish off vector component
-          long_dst_all.segment(row_component * vector_component_size,
-                               vector_component_size) += long_dst;
-        }
+#pragma omp critical
+        long_dst_all += my_long_dst;
       }
 
       // go continuous and write output
-      res.col(c) +=
-          alpha * lhs.get_transformation_matrix().transpose() * long_dst_all;
+      if (structured) {
+        Matrix<ScalarRes, Dynamic, 1> short_dst;
+        structured_transformation.applyTranspose<ScalarRes>(long_dst_all,
+                                                            &short_dst);
+        res.col(c) += alpha * short_dst;
+      } else {
+        res.col(c) +=
+            alpha * lhs.get_transformation_matrix().transpose() * long_dst_all;
+      }
     }
   }
 };
@@ -73,8 +73,8 @@ class H2Matrix : public H2MatrixBase<H2Matrix<ScalarT>> {
     Flags = NestByRefBit
   };
   // Minimum specialisation of EigenBase methods
-  Index rows() const { return transformation_matrix_.cols(); }
-  Index cols() const { return transformation_matrix_.cols(); }
+  Index rows() const { return transformation_matrix_->cols(); }
+  Index cols() const { return transformation_matrix_->cols(); }
   // Definition of the matrix multiplication
   template <typename Rhs>
   Product<H2Matrix, Rhs, AliasFreeProduct> operator*(
@@ -84,18 +84,36 @@ class H2Matrix : public H2MatrixBase<H2Matrix<ScalarT>> {
   //////////////////////////////////////////////////////////////////////////////
   /// constructors
   //////////////////////////////////////////////////////////////////////////////
-  H2Matrix() {}
+  H2Matrix()
+      : transformation_matrix_(
+            std::make_shared<const Eigen::SparseMatrix<double>>()),
+        structured_transformation_(
+            std::make_shared<const Bembel::StructuredTransformation>()),
+        memory_budget_(0),
+        nearfield_mode_(Bembel::H2NearfieldMode::Stored),
+        storage_precision_(Bembel::H2StoragePrecision::Double) {}
   /**
    * \brief Assemble H2-Matrix for linear operator linOp and AnsatzSpace
    * ansatz_space with number_of_points interpolation points in one direction of
-   * the unit square (standard is number_of_points=9)
+   * the unit square (standard is number_of_points=9). If a memory budget has
+   * been set, the parameters of the block cluster tree are chosen such that
+   * the predicted memory footprint fits into the budget. In the OnTheFly
+   * near-field mode, only the low-rank leaves are assembled.
    */
   template <typename Derived>
   void init_H2Matrix(const Derived& linOp,
                      const Bembel::AnsatzSpace<Derived>& ansatz_space,
                      int number_of_points = 9) {
-    // get transformation matrix from ansatz space
-    transformation_matrix_ = ansatz_space.get_transformation_matrix();
+    // share transformation matrix with the ansatz space
+    transformation_matrix_ = ansatz_space.get_shared_transformation_matrix();
+    structured_transformation_ =
+        ansatz_space.get_shared_structured_transformation();
+    if (nearfield_mode_ == Bembel::H2NearfieldMode::Packed &&
+        storage_precision_ != Bembel::H2StoragePrecision::Double) {
+      std::cerr << "The packed near-field is only available in double "
+                   "precision!";
+      exit(1);
+    }
     /**
      * \todo Juergen Discuss with Michael where to initialize the parameters:
      * min_cluster_level depends on number_of_points, but this is not
@@ -106,7 +124,11 @@ class H2Matrix : public H2MatrixBase<H2Matrix<ScalarT>> {
         Bembel::LinearOperatorTraits<Derived>::Form>();
     block_cluster_tree_.resize(vector_dimension, vector_dimension);
     {
-      Bembel::BlockClusterTree<Scalar> bt(linOp, ansatz_space);
+      Bembel::BlockClusterTree<Scalar> bt =
+          memory_budget_ > 0 ? fitToMemoryBudget(linOp, ansatz_space,
+                                                 number_of_points)
+                             : Bembel::BlockClusterTree<Scalar>(linOp,
+                                                                ansatz_space);
       for (int i = 0; i < vector_dimension; ++i)
         for (int j = 0; j < vector_dimension; ++j)
           block_cluster_tree_(i, j) =
@@ -125,22 +147,106 @@ class H2Matrix : public H2MatrixBase<H2Matrix<ScalarT>> {
         Moment2D<Bembel::H2Multipole::ChebychevRoots, Derived>::compute2DMoment(
             ansatz_space.get_superspace(), cluster_level, cluster_refinement,
             number_of_points);
+    fmm_moment_matrix_single_.clear();
+    if (storage_precision_ == Bembel::H2StoragePrecision::SingleWithMoments) {
+      for (auto i = 0; i < fmm_moment_matrix_.size(); ++i)
+        fmm_moment_matrix_single_.push_back(
+            fmm_moment_matrix_[i].template cast<float>());
+      fmm_moment_matrix_.clear();
+    }
     // compute interpolation points
     Eigen::VectorXd interpolation_points1D =
         Bembel::H2Multipole::ChebychevRoots(number_of_points).points_;
     Eigen::MatrixXd interpolation_points2D =
         Bembel::H2Multipole::interpolationPoints2D(interpolation_points1D);
+    // in the packed near-field mode, the dense leafs are views on contiguous
+    // memory, which is filled by the assembly
+    packed_nearfield_.resize(0, 0);
+    if (nearfield_mode_ == Bembel::H2NearfieldMode::Packed) {
+      packed_nearfield_.resize(vector_dimension, vector_dimension);
+      for (int i = 0; i < vector_dimension; ++i)
+        for (int j = 0; j < vector_dimension; ++j)
+          packed_nearfield_(i, j).init_PackedNearfield(
+              std::addressof(block_cluster_tree_(i, j)));
+    }
     // compute content of tree leafs
     int polynomial_degree = ansatz_space.get_polynomial_degree();
     int polynomial_degree_plus_one_squared =
         (polynomial_degree + 1) * (polynomial_degree + 1);
-    Bembel::GaussSquare<Bembel::Constants::maximum_quadrature_degree> GS;
+    // the quadrature rules are shared by the whole process and outlive the
+    // near-field assembler
+    const auto* GS =
+        &Bembel::getGaussSquare<Bembel::Constants::maximum_quadrature_degree>();
     auto super_space = ansatz_space.get_superspace();
     auto ffield_deg = linOp.get_FarfieldQuadratureDegree(polynomial_degree);
-    std::vector<ElementSurfacePoints> ffield_qnodes =
-        Bembel::DuffyTrick::computeFfieldQnodes(super_space, GS[ffield_deg]);
+    auto ffield_qnodes =
+        super_space.get_mesh().get_quadrature_points((*GS)[ffield_deg]);
     const int NumberOfFMMComponents =
         Bembel::LinearOperatorTraits<Derived>::NumberOfFMMComponents;
+    // the near-field assembler keeps everything required to (re-)integrate a
+    // dense leaf, such that it may also be called during the matrix-vector
+    // multiplication
+    nearfield_assembler_ = [linOp, super_space, GS, ffield_qnodes,
+                            vector_dimension,
+                            polynomial_degree_plus_one_squared](
+                               const Bembel::ElementTreeNode& cluster1,
+                               const Bembel::ElementTreeNode& cluster2) {
+      int rows = std::distance(cluster1.begin(), cluster1.end()) *
+                 polynomial_degree_plus_one_squared;
+      int cols = std::distance(cluster2.begin(), cluster2.end()) *
+                 polynomial_degree_plus_one_squared;
+      std::vector<Eigen::Matrix<ScalarT, Eigen::Dynamic, Eigen::Dynamic>> F;
+      for (int i = 0; i < vector_dimension * vector_dimension; ++i)
+        F.push_back(
+            Eigen::Matrix<ScalarT, Eigen::Dynamic, Eigen::Dynamic>(rows, cols));
+      Eigen::Matrix<ScalarT, Eigen::Dynamic, Eigen::Dynamic> intval(
+          vector_dimension * polynomial_degree_plus_one_squared,
+          vector_dimension * polynomial_degree_plus_one_squared);
+      // iterate over elements in dense matrix block
+      unsigned int cl1index = 0;
+      unsigned int cl2index = 0;
+      for (const auto& element1 : cluster1) {
+        cl2index = 0;
+        for (const auto& element2 : cluster2) {
+          // do integration
+          Bembel::DuffyTrick::evaluateBilinearForm(
+              linOp, super_space, element1, element2, *GS,
+              (*ffield_qnodes)[element1.id_], (*ffield_qnodes)[element2.id_],
+              &intval);
+          // insert into dense matrices of all block cluster trees
+          for (int i = 0; i < vector_dimension; ++i)
+            for (int j = 0; j < vector_dimension; ++j)
+              F[i * vector_dimension + j].block(
+                  polynomial_degree_plus_one_squared * cl1index,
+                  polynomial_degree_plus_one_squared * cl2index,
+                  polynomial_degree_plus_one_squared,
+                  polynomial_degree_plus_one_squared) =
+                  intval.block(j * polynomial_degree_plus_one_squared,
+                               i * polynomial_degree_plus_one_squared,
+                               polynomial_degree_plus_one_squared,
+                               polynomial_degree_plus_one_squared);
+          ++cl2index;
+        }
+        ++cl1index;
+      }
+      return F;
+    };
+    // the adaptive near-field quadrature fixes its degrees on the element
+    // pairs of the dense leafs beforehand
+    if (linOp.get_nearfield_quadrature_tolerance() > 0) {
+      std::vector<std::pair<const Bembel::ElementTreeNode*,
+                            const Bembel::ElementTreeNode*>>
+          pairs;
+      for (auto leaf = block_cluster_tree_(0, 0).lbegin();
+           leaf != block_cluster_tree_(0, 0).lend(); ++leaf)
+        if ((*leaf)->get_cc() == Bembel::BlockClusterAdmissibility::Dense)
+          for (const auto& element1 : *((*leaf)->get_cluster1()))
+            for (const auto& element2 : *((*leaf)->get_cluster2()))
+              pairs.push_back(std::make_pair(std::addressof(element1),
+                                             std::addressof(element2)));
+      Bembel::DuffyTrick::computeNearfieldQuadratureDegrees(
+          linOp, super_space, pairs, *GS, *ffield_qnodes);
+    }
 #pragma omp parallel
     {
 #pragma omp single
@@ -161,54 +267,17 @@ class H2Matrix : public H2MatrixBase<H2Matrix<ScalarT>> {
             switch ((*(leafs[0]))->get_cc()) {
               // assemble dense matrix blocks
               case Bembel::BlockClusterAdmissibility::Dense: {
-                const Bembel::ElementTreeNode* cluster1 =
-                    (*(leafs[0]))->get_cluster1();
-                const Bembel::ElementTreeNode* cluster2 =
-                    (*(leafs[0]))->get_cluster2();
-                int block_size =
-                    std::distance(cluster2->begin(), cluster2->end()) *
-                    polynomial_degree_plus_one_squared;
-                std::vector<
-                    Eigen::Matrix<ScalarT, Eigen::Dynamic, Eigen::Dynamic>>
-                    F;
-                for (int i = 0; i < vector_dimension * vector_dimension; ++i)
-                  F.push_back(
-                      Eigen::Matrix<ScalarT, Eigen::Dynamic, Eigen::Dynamic>(
-                          block_size, block_size));
-                // iterate over elements in dense matrix block
-                unsigned int cl1index = 0;
-                unsigned int cl2index = 0;
-                for (const auto& element1 : *cluster1) {
-                  cl2index = 0;
-                  for (const auto& element2 : *cluster2) {
-                    Eigen::Matrix<ScalarT, Eigen::Dynamic, Eigen::Dynamic>
-                        intval(vector_dimension *
-                                   polynomial_degree_plus_one_squared,
-                               vector_dimension *
-                                   polynomial_degree_plus_one_squared);
-                    // do integration
-                    Bembel::DuffyTrick::evaluateBilinearForm(
-                        linOp, super_space, element1, element2, GS,
-                        ffield_qnodes[element1.id_],
-                        ffield_qnodes[element2.id_], &intval);
-                    // insert into dense matrices of all block cluster trees
-                    for (int i = 0; i < vector_dimension; ++i)
-                      for (int j = 0; j < vector_dimension; ++j)
-                        F[i * vector_dimension + j].block(
-                            polynomial_degree_plus_one_squared * cl1index,
-                            polynomial_degree_plus_one_squared * cl2index,
-                            polynomial_degree_plus_one_squared,
-                            polynomial_degree_plus_one_squared) =
-                            intval.block(j * polynomial_degree_plus_one_squared,
-                                         i * polynomial_degree_plus_one_squared,
-                                         polynomial_degree_plus_one_squared,
-                                         polynomial_degree_plus_one_squared);
-                    ++cl2index;
-                  }
-                  ++cl1index;
-                }
-                for (int i = 0; i < vector_dimension * vector_dimension; ++i)
+                // in the on-the-fly mode, dense blocks are only kept as
+                // cluster pairs and assembled within the matrix-vector
+                // multiplication
+                if (nearfield_mode_ == Bembel::H2NearfieldMode::OnTheFly) break;
+                auto F = nearfield_assembler_(*((*(leafs[0]))->get_cluster1()),
+                                              *((*(leafs[0]))->get_cluster2()));
+                for (int i = 0; i < vector_dimension * vector_dimension; ++i) {
                   (*(leafs[i]))->get_leaf().set_F(F[i]);
+                  if (storage_precision_ != Bembel::H2StoragePrecision::Double)
+                    (*(leafs[i]))->get_leaf().convertToSinglePrecision();
+                }
               } break;
               // interpolation for low-rank blocks
               case Bembel::BlockClusterAdmissibility::LowRank: {
@@ -231,6 +300,11 @@ class H2Matrix : public H2MatrixBase<H2Matrix<ScalarT>> {
                     (*(leafs[i * vector_dimension + j]))
                         ->get_leaf()
                         .set_low_rank_flag(true);
+                    if (storage_precision_ !=
+                        Bembel::H2StoragePrecision::Double)
+                      (*(leafs[i * vector_dimension + j]))
+                          ->get_leaf()
+                          .convertToSinglePrecision();
                   }
                 }
               } break;
@@ -262,22 +336,112 @@ class H2Matrix : public H2MatrixBase<H2Matrix<ScalarT>> {
     }
     return dense;
   }
+  /**
+   * \brief Returns the memory consumption of the assembled H2Matrix broken
+   * down into its components.
+   */
+  Bembel::H2MemoryFootprint get_memory_footprint() const {
+    Bembel::H2MemoryFootprint footprint;
+    for (int i = 0; i < block_cluster_tree_.rows(); ++i)
+      for (int j = 0; j < block_cluster_tree_.cols(); ++j)
+        for (auto it = block_cluster_tree_(i, j).clbegin();
+             it != block_cluster_tree_(i, j).clend(); ++it) {
+          const auto& leaf = (*it)->get_leaf();
+          std::size_t size = leaf.get_F_view().size() + leaf.get_L().size() +
+                             leaf.get_R().size();
+          footprint.addLeaf(
+              (*it)->get_level() + 1, (*it)->get_cc(),
+              size * sizeof(ScalarT) +
+                  leaf.get_F_single().size() *
+                      sizeof(typename Bembel::SinglePrecision<ScalarT>::type));
+        }
+    for (auto i = 0; i < fmm_moment_matrix_.size(); ++i)
+      footprint.moment_matrices_ +=
+          fmm_moment_matrix_[i].size() * sizeof(double);
+    for (auto i = 0; i < fmm_moment_matrix_single_.size(); ++i)
+      footprint.moment_matrices_ +=
+          fmm_moment_matrix_single_[i].size() * sizeof(float);
+    footprint.transfer_matrices_ =
+        fmm_transfer_matrices_.size() * sizeof(double);
+    footprint.transformation_matrix_ =
+        Bembel::sparseMatrixMemory(*transformation_matrix_);
+    return footprint;
+  }
+  /**
+   * \brief Integrates all vector components of the dense leaf belonging to
+   * cluster1 and cluster2. Entry i * vector_dimension + j corresponds to the
+   * block cluster tree (j, i).
+   */
+  std::vector<Eigen::Matrix<ScalarT, Eigen::Dynamic, Eigen::Dynamic>>
+  computeNearfieldLeaf(const Bembel::ElementTreeNode& cluster1,
+                       const Bembel::ElementTreeNode& cluster2) const {
+    return nearfield_assembler_(cluster1, cluster2);
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// setter
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Sets the storage mode of the dense leaves, see H2NearfieldMode.
+   * Has to be called before init_H2Matrix.
+   */
+  void set_nearfield_mode(int nearfield_mode) {
+    nearfield_mode_ = nearfield_mode;
+    return;
+  }
+  /**
+   * \brief Sets the storage precision, see H2StoragePrecision. Has to be
+   * called before init_H2Matrix.
+   */
+  void set_storage_precision(int storage_precision) {
+    storage_precision_ = storage_precision;
+    return;
+  }
+  /**
+   * \brief Sets a memory budget in bytes for init_H2Matrix. A budget of 0
+   * means that the default parameters of the block cluster tree are used.
+   */
+  void set_memory_budget(std::size_t memory_budget) {
+    memory_budget_ = memory_budget;
+    return;
+  }
   //////////////////////////////////////////////////////////////////////////////
   /// getter
   //////////////////////////////////////////////////////////////////////////////
-  const Eigen::SparseMatrix<double> get_transformation_matrix() const {
-    return transformation_matrix_;
+  std::size_t get_memory_budget() const { return memory_budget_; }
+  int get_nearfield_mode() const { return nearfield_mode_; }
+  int get_storage_precision() const { return storage_precision_; }
+  const Eigen::SparseMatrix<double>& get_transformation_matrix() const {
+    return *transformation_matrix_;
+  }
+  const Bembel::StructuredTransformation& get_structured_transformation()
+      const {
+    return *structured_transformation_;
   }
-  const Eigen::MatrixXd get_fmm_transfer_matrices() const {
+  const Eigen::MatrixXd& get_fmm_transfer_matrices() const {
     return fmm_transfer_matrices_;
   }
-  const std::vector<Eigen::MatrixXd> get_fmm_moment_matrix() const {
+  /**
+   * \brief Returns the moment matrices in double precision, which are empty
+   * if they are stored in single precision.
+   */
+  const std::vector<Eigen::MatrixXd>& get_fmm_moment_matrix() const {
     return fmm_moment_matrix_;
   }
+  /**
+   * \brief Returns the moment matrices in single precision, which are empty
+   * unless the storage precision is SingleWithMoments.
+   */
+  const std::vector<Eigen::MatrixXf>& get_fmm_moment_matrix_single() const {
+    return fmm_moment_matrix_single_;
+  }
   const Bembel::GenericMatrix<Bembel::BlockClusterTree<ScalarT>>&
   get_block_cluster_tree() const {
     return block_cluster_tree_;
   }
+  const Bembel::GenericMatrix<Bembel::PackedNearfield<ScalarT>>&
+  get_packed_nearfield() const {
+    return packed_nearfield_;
+  }
   //////////////////////////////////////////////////////////////////////////////
   /// private members
   //////////////////////////////////////////////////////////////////////////////
@@ -288,11 +452,84 @@ class H2Matrix : public H2MatrixBase<H2Matrix<ScalarT>> {
   H2Matrix(H2Matrix<ScalarT>&& H);
   H2Matrix& operator=(const H2Matrix<ScalarT>& H);
   H2Matrix& operator=(H2Matrix<ScalarT>&& H);
+  /**
+   * \brief Sets up the block cluster tree with the most accurate parameters
+   * whose predicted memory footprint fits into the memory budget.
+   *
+   * The admissibility parameter eta is only relaxed if no min_cluster_level
+   * fits for the current one. For a given eta, the min_cluster_level closest
+   * to the default is preferred. If no parameters fit, the ones with the
+   * smallest footprint are used.
+   */
+  template <typename Derived>
+  Bembel::BlockClusterTree<ScalarT> fitToMemoryBudget(
+      const Derived& linOp, const Bembel::AnsatzSpace<Derived>& ansatz_space,
+      int number_of_points) const {
+    const int vector_dimension = Bembel::getFunctionSpaceVectorDimension<
+        Bembel::LinearOperatorTraits<Derived>::Form>();
+    const int NumberOfFMMComponents =
+        Bembel::LinearOperatorTraits<Derived>::NumberOfFMMComponents;
+    const int max_level = ansatz_space.get_superspace()
+                              .get_mesh()
+                              .get_element_tree()
+                              .get_max_level();
+    // default parameters of the block cluster tree
+    Bembel::BlockClusterTree<ScalarT> defaults;
+    defaults.set_parameters();
+    const double eta = defaults.get_parameters().eta_;
+    const int min_cluster_level = defaults.get_parameters().min_cluster_level_;
+    const double eta_factors[] = {1., 1.5, 2., 3., 4.};
+    Bembel::BlockClusterTree<ScalarT> smallest;
+    std::size_t smallest_footprint = std::numeric_limits<std::size_t>::max();
+    for (auto eta_factor : eta_factors) {
+      for (int distance = 0; distance <= max_level; ++distance) {
+        for (int level :
+             {min_cluster_level + distance, min_cluster_level - distance}) {
+          if (level < 0 || level > max_level) continue;
+          Bembel::BlockClusterTree<ScalarT> bt;
+          bt.set_parameters(eta * eta_factor, level);
+          bt.init_BlockClusterTree(linOp, ansatz_space);
+          std::size_t footprint =
+              Bembel::estimateH2MemoryFootprint(
+                  bt, vector_dimension, NumberOfFMMComponents,
+                  number_of_points, *transformation_matrix_,
+                  nearfield_mode_ != Bembel::H2NearfieldMode::OnTheFly,
+                  storage_precision_ == Bembel::H2StoragePrecision::Double
+                      ? sizeof(ScalarT)
+                      : sizeof(typename Bembel::SinglePrecision<ScalarT>::type),
+                  storage_precision_ ==
+                          Bembel::H2StoragePrecision::SingleWithMoments
+                      ? sizeof(float)
+                      : sizeof(double))
+                  .total();
+          if (footprint <= memory_budget_) return bt;
+          if (footprint < smallest_footprint) {
+            smallest_footprint = footprint;
+            smallest = bt;
+          }
+          // both candidates coincide for the default min_cluster_level
+          if (distance == 0) break;
+        }
+      }
+    }
+    return smallest;
+  }
 
-  Eigen::SparseMatrix<double> transformation_matrix_;
+  std::shared_ptr<const Eigen::SparseMatrix<double>> transformation_matrix_;
+  std::shared_ptr<const Bembel::StructuredTransformation>
+      structured_transformation_;
   Bembel::GenericMatrix<Bembel::BlockClusterTree<ScalarT>> block_cluster_tree_;
   Eigen::MatrixXd fmm_transfer_matrices_;
   std::vector<Eigen::MatrixXd> fmm_moment_matrix_;
+  std::vector<Eigen::MatrixXf> fmm_moment_matrix_single_;
+  Bembel::GenericMatrix<Bembel::PackedNearfield<ScalarT>> packed_nearfield_;
+  std::size_t memory_budget_;
+  int nearfield_mode_;
+  int storage_precision_;
+  std::function<std::vector<
+      Eigen::Matrix<ScalarT, Eigen::Dynamic, Eigen::Dynamic>>(
+      const Bembel::ElementTreeNode&, const Bembel::ElementTreeNode&)>
+      nearfield_assembler_;
 };
 
 namespace internal {
@@ -0,0 +1,166 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+#ifndef BEMBEL_SRC_H2MATRIX_H2MEMORYFOOTPRINT_HPP_
+#define BEMBEL_SRC_H2MATRIX_H2MEMORYFOOTPRINT_HPP_
+
+namespace Bembel {
+/**
+ * \ingroup H2Matrix
+ * \brief Breaks down the memory consumption of an H2Matrix in bytes.
+ *
+ * The histograms are indexed by the depth of the leaf in the block cluster
+ * tree, i.e., entry 0 corresponds to the root, entry 1 to blocks of patches
+ * and entry l to blocks of clusters on level l-1 of the element tree.
+ */
+struct H2MemoryFootprint {
+  //////////////////////////////////////////////////////////////////////////////
+  /// constructors
+  //////////////////////////////////////////////////////////////////////////////
+  H2MemoryFootprint()
+      : dense_leaves_(0),
+        low_rank_leaves_(0),
+        moment_matrices_(0),
+        transfer_matrices_(0),
+        transformation_matrix_(0) {}
+  //////////////////////////////////////////////////////////////////////////////
+  /// methods
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Adds a leaf of the block cluster tree to the footprint.
+   *
+   * \param depth Depth of the leaf in the block cluster tree.
+   * \param cc BlockClusterAdmissibility of the leaf.
+   * \param bytes Memory occupied by the leaf.
+   */
+  void addLeaf(int depth, int cc, std::size_t bytes) {
+    if (depth >= dense_leaves_per_depth_.size()) {
+      dense_leaves_per_depth_.resize(depth + 1, 0);
+      low_rank_leaves_per_depth_.resize(depth + 1, 0);
+      number_of_dense_leaves_per_depth_.resize(depth + 1, 0);
+      number_of_low_rank_leaves_per_depth_.resize(depth + 1, 0);
+    }
+    if (cc == BlockClusterAdmissibility::Dense) {
+      dense_leaves_ += bytes;
+      dense_leaves_per_depth_[depth] += bytes;
+      ++number_of_dense_leaves_per_depth_[depth];
+    } else {
+      low_rank_leaves_ += bytes;
+      low_rank_leaves_per_depth_[depth] += bytes;
+      ++number_of_low_rank_leaves_per_depth_[depth];
+    }
+    return;
+  }
+  /**
+   * \brief Returns the overall memory consumption in bytes.
+   */
+  std::size_t total() const {
+    return dense_leaves_ + low_rank_leaves_ + moment_matrices_ +
+           transfer_matrices_ + transformation_matrix_;
+  }
+  /**
+   * \brief Prints the break down of the memory consumption in MB.
+   */
+  void print() const {
+    const double MB = 1024. * 1024.;
+    std::cout << "{" << std::endl;
+    std::cout << "dense leaves:          " << dense_leaves_ / MB << std::endl;
+    std::cout << "low-rank leaves:       " << low_rank_leaves_ / MB
+              << std::endl;
+    std::cout << "moment matrices:       " << moment_matrices_ / MB
+              << std::endl;
+    std::cout << "transfer matrices:     " << transfer_matrices_ / MB
+              << std::endl;
+    std::cout << "transformation matrix: " << transformation_matrix_ / MB
+              << std::endl;
+    std::cout << "total:                 " << total() / MB << std::endl;
+    std::cout << "depth  #dense  dense  #low-rank  low-rank" << std::endl;
+    for (auto i = 0; i < dense_leaves_per_depth_.size(); ++i)
+      std::cout << i << "  " << number_of_dense_leaves_per_depth_[i] << "  "
+                << dense_leaves_per_depth_[i] / MB << "  "
+                << number_of_low_rank_leaves_per_depth_[i] << "  "
+                << low_rank_leaves_per_depth_[i] / MB << std::endl;
+    std::cout << "}" << std::endl;
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// member variables
+  //////////////////////////////////////////////////////////////////////////////
+  std::size_t dense_leaves_;           /// near-field matrix blocks
+  std::size_t low_rank_leaves_;        /// far-field coupling matrices
+  std::size_t moment_matrices_;        /// fmm moment matrices
+  std::size_t transfer_matrices_;      /// fmm transfer matrices
+  std::size_t transformation_matrix_;  /// local to global transformation
+  std::vector<std::size_t> dense_leaves_per_depth_;
+  std::vector<std::size_t> low_rank_leaves_per_depth_;
+  std::vector<int> number_of_dense_leaves_per_depth_;
+  std::vector<int> number_of_low_rank_leaves_per_depth_;
+};
+/**
+ * \ingroup H2Matrix
+ * \brief Returns the memory occupied by a compressed sparse matrix in bytes.
+ */
+template <typename Scalar>
+std::size_t sparseMatrixMemory(const Eigen::SparseMatrix<Scalar> &matrix) {
+  typedef typename Eigen::SparseMatrix<Scalar>::StorageIndex StorageIndex;
+  return matrix.nonZeros() * (sizeof(Scalar) + sizeof(StorageIndex)) +
+         (matrix.outerSize() + 1) * sizeof(StorageIndex);
+}
+/**
+ * \ingroup H2Matrix
+ * \brief Predicts the memory footprint of an H2Matrix from the structure of
+ * its block cluster tree, i.e., before any leaf has been assembled.
+ *
+ * \param block_cluster_tree Block cluster tree of one vector component.
+ * \param vector_dimension Vector dimension of the function space.
+ * \param number_of_FMM_components Number of FMM components of the operator.
+ * \param number_of_points Number of interpolation points in one direction.
+ * \param transformation_matrix Transformation matrix of the ansatz space.
+ * \param store_dense_leaves False if the dense leaves are computed on the
+ * fly, see H2NearfieldMode.
+ * \param leaf_scalar_size Size of the scalar type the leaves are stored in.
+ * \param moment_scalar_size Size of the scalar type of the moment matrices.
+ */
+template <typename Scalar>
+H2MemoryFootprint estimateH2MemoryFootprint(
+    const BlockClusterTree<Scalar> &block_cluster_tree, int vector_dimension,
+    int number_of_FMM_components, int number_of_points,
+    const Eigen::SparseMatrix<double> &transformation_matrix,
+    bool store_dense_leaves = true,
+    std::size_t leaf_scalar_size = sizeof(Scalar),
+    std::size_t moment_scalar_size = sizeof(double)) {
+  H2MemoryFootprint footprint;
+  const auto &parameters = block_cluster_tree.get_parameters();
+  const std::size_t np2 = number_of_points * number_of_points;
+  const std::size_t p2 = parameters.polynomial_degree_plus_one_squared_;
+  const std::size_t components = vector_dimension * vector_dimension;
+  const std::size_t low_rank_size =
+      np2 * number_of_FMM_components * np2 * number_of_FMM_components;
+  for (auto it = block_cluster_tree.clbegin(); it != block_cluster_tree.clend();
+       ++it) {
+    std::size_t size = low_rank_size;
+    if ((*it)->get_cc() == BlockClusterAdmissibility::Dense)
+      size = store_dense_leaves ? p2 * (*it)->rows() * p2 * (*it)->cols() : 0;
+    footprint.addLeaf((*it)->get_level() + 1, (*it)->get_cc(),
+                      components * size * leaf_scalar_size);
+  }
+  int cluster_refinement =
+      std::min(parameters.min_cluster_level_, parameters.max_level_);
+  footprint.moment_matrices_ = vector_dimension * np2 *
+                               number_of_FMM_components * p2 *
+                               (1 << 2 * cluster_refinement) *
+                               moment_scalar_size;
+  footprint.transfer_matrices_ = np2 * 4 * np2 * sizeof(double);
+  footprint.transformation_matrix_ = sparseMatrixMemory(transformation_matrix);
+  return footprint;
+}
+}  // namespace Bembel
+#endif  // BEMBEL_SRC_H2MATRIX_H2MEMORYFOOTPRINT_HPP_
@@ -131,9 +131,9 @@ struct Moment1D {
     int polynomial_degree_plus_one = polynomial_degree + 1;
     int polynomial_degree_plus_one_squared =
         polynomial_degree_plus_one * polynomial_degree_plus_one;
-    GaussLegendre<Constants::maximum_quadrature_degree> GL;
-    auto Q =
-        GL[(int)std::ceil(0.5 * (number_of_points + polynomial_degree - 2))];
+    const Quadrature<1> &Q =
+        getGaussLegendre<Constants::maximum_quadrature_degree>()[(int)std::ceil(
+            0.5 * (number_of_points + polynomial_degree - 2))];
 
     Eigen::VectorXd x = InterpolationPoints(number_of_points).points_;
     Eigen::MatrixXd L =
@@ -183,9 +183,9 @@ struct Moment1DDerivative {
     int polynomial_degree_plus_one = polynomial_degree + 1;
     int polynomial_degree_plus_one_squared =
         polynomial_degree_plus_one * polynomial_degree_plus_one;
-    GaussLegendre<Constants::maximum_quadrature_degree> GL;
-    auto Q =
-        GL[(int)std::ceil(0.5 * (number_of_points + polynomial_degree - 2))];
+    const Quadrature<1> &Q =
+        getGaussLegendre<Constants::maximum_quadrature_degree>()[(int)std::ceil(
+            0.5 * (number_of_points + polynomial_degree - 2))];
 
     Eigen::VectorXd x = InterpolationPoints(number_of_points).points_;
     Eigen::MatrixXd L =
@@ -375,11 +375,19 @@ interpolateKernel(const LinOp &linOp, const SuperSpace<LinOp> &super_space,
 }
 /**
  * \ingroup H2Matrix
- * \brief Forward transformation for FMM.
+ * \brief Number of columns of the moment matrices which are cast to double
+ * precision at once if the moment matrices are stored in single precision.
  */
-template <typename Scalar>
+constexpr int moment_cast_block_size = 256;
+/**
+ * \ingroup H2Matrix
+ * \brief Forward transformation for FMM. The moment matrices may be stored in
+ * single precision, in which case they are cast blockwise.
+ */
+template <typename Scalar, typename MomentScalar>
 std::vector<Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>>
-forwardTransformation(const Eigen::MatrixXd &moment_matrices,
+forwardTransformation(const Eigen::Matrix<MomentScalar, Eigen::Dynamic,
+                                          Eigen::Dynamic> &moment_matrices,
                       const Eigen::MatrixXd &transfer_matrices, const int steps,
                       const Eigen::Matrix<Scalar, Eigen::Dynamic,
                                           Eigen::Dynamic> &long_rhs_matrix) {
@@ -389,7 +397,16 @@ forwardTransformation(const Eigen::MatrixXd &moment_matrices,
   // apply moment matrices
   std::vector<Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>>
       long_rhs_forward;
-  long_rhs_forward.push_back(moment_matrices * long_rhs_matrix);
+  long_rhs_forward.push_back(
+      Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
+          moment_matrices.rows(), long_rhs_matrix.cols()));
+  for (int k = 0; k < moment_matrices.cols(); k += moment_cast_block_size) {
+    const int n = std::min(moment_cast_block_size,
+                           static_cast<int>(moment_matrices.cols()) - k);
+    long_rhs_forward[0].noalias() +=
+        moment_matrices.middleCols(k, n).template cast<double>() *
+        long_rhs_matrix.middleRows(k, n);
+  }
   // apply transfer matrices
   for (int i = 0; i < steps; ++i) {
     Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> reshaped =
@@ -423,11 +440,13 @@ forwardTransformation(const Eigen::MatrixXd &moment_matrices,
 /**
  * \ingroup H2Matrix
  * \brief Backward transformation for FMM. The content of long_dst_backward is
- * destroyed.
+ * destroyed. The moment matrices may be stored in single precision, in which
+ * case they are cast blockwise.
  */
-template <typename Scalar>
+template <typename Scalar, typename MomentScalar>
 Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> backwardTransformation(
-    const Eigen::MatrixXd &moment_matrices,
+    const Eigen::Matrix<MomentScalar, Eigen::Dynamic, Eigen::Dynamic>
+        &moment_matrices,
     const Eigen::MatrixXd &transfer_matrices, const int steps,
     std::vector<Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>>
         &long_dst_backward) {
@@ -462,8 +481,15 @@ Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> backwardTransformation(
             long_dst_backward[i - 1].cols());
   }
   // apply moment matrices
-  Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> long_dst_matrix =
-      moment_matrices.transpose() * long_dst_backward[0];
+  Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> long_dst_matrix(
+      moment_matrices.cols(), long_dst_backward[0].cols());
+  for (int k = 0; k < moment_matrices.cols(); k += moment_cast_block_size) {
+    const int n = std::min(moment_cast_block_size,
+                           static_cast<int>(moment_matrices.cols()) - k);
+    long_dst_matrix.middleRows(k, n).noalias() =
+        moment_matrices.middleCols(k, n).template cast<double>().transpose() *
+        long_dst_backward[0];
+  }
   return Eigen::Map<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>(
       long_dst_matrix.data(), long_dst_matrix.size());
 }
@@ -0,0 +1,131 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+#ifndef BEMBEL_SRC_H2MATRIX_PACKEDNEARFIELD_HPP_
+#define BEMBEL_SRC_H2MATRIX_PACKEDNEARFIELD_HPP_
+
+namespace Bembel {
+/**
+ * \ingroup H2Matrix
+ * \brief Contiguous storage of the dense leaves of a block cluster tree.
+ *
+ * All dense blocks are stored column major one after another in a single
+ * arena, ordered by their row cluster and then by their column cluster. The
+ * blocks are indexed in a block-CSR fashion, i.e., the blocks of block row i
+ * are row_ptr_[i], ..., row_ptr_[i + 1] - 1. The tree leaves of the dense
+ * blocks become views on the arena.
+ */
+template <typename Scalar>
+class PackedNearfield {
+ public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// constructors
+  //////////////////////////////////////////////////////////////////////////////
+  PackedNearfield() {}
+  //////////////////////////////////////////////////////////////////////////////
+  /// init
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Sets up the arena for the dense leaves of a block cluster tree and
+   * turns the tree leaves into views on it. This is meant to be called before
+   * the assembly, such that the dense leaves are assembled directly into the
+   * arena and never exist twice.
+   */
+  void init_PackedNearfield(BlockClusterTree<Scalar> *block_cluster_tree) {
+    // collect dense leaves and order them by row and column clusters
+    std::vector<BlockClusterTree<Scalar> *> dense_leaves;
+    std::vector<std::array<int, 5>> ranges;
+    for (auto it = block_cluster_tree->lbegin();
+         it != block_cluster_tree->lend(); ++it)
+      if ((*it)->get_cc() == BlockClusterAdmissibility::Dense) {
+        std::array<int, 5> range = {{(*it)->get_row_start_index(),
+                                     (*it)->get_row_end_index(),
+                                     (*it)->get_col_start_index(),
+                                     (*it)->get_col_end_index(),
+                                     static_cast<int>(dense_leaves.size())}};
+        ranges.push_back(range);
+        dense_leaves.push_back(*it);
+      }
+    std::sort(ranges.begin(), ranges.end());
+    // set up block-CSR index
+    row_ptr_.clear();
+    row_start_.clear();
+    row_size_.clear();
+    col_start_.resize(ranges.size());
+    col_size_.resize(ranges.size());
+    offset_.resize(ranges.size());
+    std::size_t size = 0;
+    for (auto i = 0; i < ranges.size(); ++i) {
+      if (i == 0 || ranges[i][0] != ranges[i - 1][0]) {
+        row_ptr_.push_back(i);
+        row_start_.push_back(ranges[i][0]);
+        row_size_.push_back(ranges[i][1] - ranges[i][0]);
+      }
+      col_start_[i] = ranges[i][2];
+      col_size_[i] = ranges[i][3] - ranges[i][2];
+      offset_[i] = size;
+      size += std::size_t(row_size_.back()) * col_size_[i];
+    }
+    row_ptr_.push_back(ranges.size());
+    // allocate the arena and let the leaves point into it
+    values_.assign(size, Scalar(0.));
+    for (auto i = 0; i < ranges.size(); ++i)
+      dense_leaves[ranges[i][4]]->get_leaf().set_packed_F(
+          values_.data() + offset_[i], ranges[i][1] - ranges[i][0],
+          col_size_[i]);
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// methods
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Adds the product of block row i with rhs to dst.
+   */
+  template <typename Rhs, typename Dst>
+  void applyBlockRow(int i, const Eigen::MatrixBase<Rhs> &rhs,
+                     Eigen::MatrixBase<Dst> *dst) const {
+    for (auto j = row_ptr_[i]; j < row_ptr_[i + 1]; ++j)
+      dst->segment(row_start_[i], row_size_[i]).noalias() +=
+          Eigen::Map<const Eigen::Matrix<Scalar, Eigen::Dynamic,
+                                         Eigen::Dynamic>>(
+              values_.data() + offset_[j], row_size_[i], col_size_[j]) *
+          rhs.segment(col_start_[j], col_size_[j]);
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// getter
+  //////////////////////////////////////////////////////////////////////////////
+  int get_number_of_block_rows() const { return row_start_.size(); }
+  int get_number_of_blocks() const { return offset_.size(); }
+  /**
+   * \brief Returns the memory of the arena and the index in bytes.
+   */
+  std::size_t get_memory() const {
+    return values_.size() * sizeof(Scalar) +
+           (row_ptr_.size() + row_start_.size() + row_size_.size() +
+            col_start_.size() + col_size_.size()) *
+               sizeof(int) +
+           offset_.size() * sizeof(std::size_t);
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// member variables
+  //////////////////////////////////////////////////////////////////////////////
+ private:
+  std::vector<Scalar> values_;
+  std::vector<int> row_ptr_;
+  std::vector<int> row_start_;
+  std::vector<int> row_size_;
+  std::vector<int> col_start_;
+  std::vector<int> col_size_;
+  std::vector<std::size_t> offset_;
+};
+}  // namespace Bembel
+#endif  // BEMBEL_SRC_H2MATRIX_PACKEDNEARFIELD_HPP_
@@ -13,6 +13,18 @@
 #define BEMBEL_SRC_H2MATRIX_TREELEAF_HPP_
 
 namespace Bembel {
+/**
+ * \brief Maps a scalar type to its single precision counterpart, which is
+ * used for the reduced precision storage of tree leafs.
+ */
+template <typename Scalar>
+struct SinglePrecision {
+  typedef float type;
+};
+template <>
+struct SinglePrecision<std::complex<double>> {
+  typedef std::complex<float> type;
+};
 /**
  * \brief This class is managing the leafs of the H2Matrix BlockClusterTree.
  */
@@ -29,6 +41,10 @@ class TreeLeaf {
       : F_(Derived(0, 0)),
         L_(Derived(0, 0)),
         R_(Derived(0, 0)),
+        packed_F_(nullptr),
+        packed_rows_(0),
+        packed_cols_(0),
+        is_single_precision_(false),
         is_low_rank_(false) {}
   /**
    * \brief copy constructor
@@ -37,6 +53,11 @@ class TreeLeaf {
       : F_(other.F_),
         L_(other.L_),
         R_(other.R_),
+        F_single_(other.F_single_),
+        packed_F_(other.packed_F_),
+        packed_rows_(other.packed_rows_),
+        packed_cols_(other.packed_cols_),
+        is_single_precision_(other.is_single_precision_),
         is_low_rank_(other.is_low_rank_) {}
   /**
    * \brief move constructor
@@ -45,6 +66,11 @@ class TreeLeaf {
       : F_(std::move(other.F_)),
         L_(std::move(other.L_)),
         R_(std::move(other.R_)),
+        F_single_(std::move(other.F_single_)),
+        packed_F_(other.packed_F_),
+        packed_rows_(other.packed_rows_),
+        packed_cols_(other.packed_cols_),
+        is_single_precision_(other.is_single_precision_),
         is_low_rank_(other.is_low_rank_) {}
   /**
    * \brief lowRank constructor
@@ -53,24 +79,52 @@ class TreeLeaf {
   template <typename otherDerived>
   TreeLeaf(const Eigen::MatrixBase<otherDerived> &L,
            const Eigen::MatrixBase<otherDerived> &R)
-      : F_(Derived(0, 0)), L_(L), R_(R), is_low_rank_(true) {}
+      : F_(Derived(0, 0)),
+        L_(L),
+        R_(R),
+        packed_F_(nullptr),
+        packed_rows_(0),
+        packed_cols_(0),
+        is_single_precision_(false),
+        is_low_rank_(true) {}
   /**
    * \brief full constructor
    *        whatever Eigen object is put in here will be evaluated
    **/
   template <typename otherDerived>
   explicit TreeLeaf(const Eigen::MatrixBase<otherDerived> &F)
-      : F_(F), L_(Derived(0, 0)), R_(Derived(0, 0)), is_low_rank_(false) {}
+      : F_(F),
+        L_(Derived(0, 0)),
+        R_(Derived(0, 0)),
+        packed_F_(nullptr),
+        packed_rows_(0),
+        packed_cols_(0),
+        is_single_precision_(false),
+        is_low_rank_(false) {}
   /**
    * \brief lowRank move constructor
    **/
   TreeLeaf(Derived &&L, Derived &&R)
-      : F_(Derived(0, 0)), L_(L), R_(R), is_low_rank_(true) {}
+      : F_(Derived(0, 0)),
+        L_(L),
+        R_(R),
+        packed_F_(nullptr),
+        packed_rows_(0),
+        packed_cols_(0),
+        is_single_precision_(false),
+        is_low_rank_(true) {}
   /**
    * \brief full move constructor
    **/
   explicit TreeLeaf(Derived &&F)
-      : F_(F), L_(Derived(0, 0)), R_(Derived(0, 0)), is_low_rank_(false) {}
+      : F_(F),
+        L_(Derived(0, 0)),
+        R_(Derived(0, 0)),
+        packed_F_(nullptr),
+        packed_rows_(0),
+        packed_cols_(0),
+        is_single_precision_(false),
+        is_low_rank_(false) {}
   //////////////////////////////////////////////////////////////////////////////
   //    getter
   //////////////////////////////////////////////////////////////////////////////
@@ -91,11 +145,34 @@ class TreeLeaf {
       &get_F() const {
     return F_;
   }
+  /**
+   * \brief Returns a view on the full matrix, regardless whether it is owned
+   * by the leaf or packed into the arena of a PackedNearfield.
+   */
+  Eigen::Map<const Eigen::Matrix<typename Derived::Scalar, Eigen::Dynamic,
+                                 Eigen::Dynamic>>
+  get_F_view() const {
+    typedef Eigen::Map<const Eigen::Matrix<typename Derived::Scalar,
+                                           Eigen::Dynamic, Eigen::Dynamic>>
+        View;
+    return packed_F_ ? View(packed_F_, packed_rows_, packed_cols_)
+                     : View(F_.data(), F_.rows(), F_.cols());
+  }
+  bool is_packed() const { return packed_F_ != nullptr; }
+  /**
+   * \brief Returns the full matrix if it is stored in single precision.
+   */
+  const Eigen::Matrix<typename SinglePrecision<typename Derived::Scalar>::type,
+                      Eigen::Dynamic, Eigen::Dynamic>
+      &get_F_single() const {
+    return F_single_;
+  }
+  bool is_single_precision() const { return is_single_precision_; }
   const Eigen::Matrix<typename Derived::Scalar, Eigen::Dynamic, Eigen::Dynamic>
       &get_L() const {
     return L_;
   }
-  Eigen::Matrix<typename Derived::Scalar, Eigen::Dynamic, Eigen::Dynamic>
+  const Eigen::Matrix<typename Derived::Scalar, Eigen::Dynamic, Eigen::Dynamic>
       &get_R() const {
     return R_;
   }
@@ -106,9 +183,45 @@ class TreeLeaf {
     is_low_rank_ = flag;
     return;
   }
+  /**
+   * \brief Sets the full matrix. If the leaf is a view on packed memory, F is
+   * copied into the packed memory.
+   */
   void set_F(const Eigen::Matrix<typename Derived::Scalar, Eigen::Dynamic,
                                  Eigen::Dynamic> &F) {
+    if (is_packed()) {
+      assert(F.rows() == packed_rows_ && F.cols() == packed_cols_ &&
+             "size does not match the packed memory");
+      Eigen::Map<Eigen::Matrix<typename Derived::Scalar, Eigen::Dynamic,
+                               Eigen::Dynamic>>(packed_F_, packed_rows_,
+                                                packed_cols_) = F;
+      return;
+    }
     F_ = F;
+    F_single_.resize(0, 0);
+    packed_F_ = nullptr;
+    is_single_precision_ = false;
+  }
+  /**
+   * \brief Replaces the full matrix by a copy in single precision.
+   */
+  void convertToSinglePrecision() {
+    assert(!is_packed() && "packed leafs cannot be converted");
+    F_single_ = F_.template cast<
+        typename SinglePrecision<typename Derived::Scalar>::type>();
+    F_.resize(0, 0);
+    is_single_precision_ = true;
+  }
+  /**
+   * \brief Releases the full matrix and turns the leaf into a view on
+   * packed memory, which is owned by someone else. Subsequent calls of set_F
+   * write into the packed memory.
+   */
+  void set_packed_F(typename Derived::Scalar *data, int rows, int cols) {
+    F_.resize(0, 0);
+    packed_F_ = data;
+    packed_rows_ = rows;
+    packed_cols_ = cols;
   }
   void set_L(const Eigen::Matrix<typename Derived::Scalar, Eigen::Dynamic,
                                  Eigen::Dynamic> &L) {
@@ -128,6 +241,11 @@ class TreeLeaf {
     F_.swap(other.F_);
     L_.swap(other.L_);
     R_.swap(other.R_);
+    F_single_.swap(other.F_single_);
+    std::swap(packed_F_, other.packed_F_);
+    std::swap(packed_rows_, other.packed_rows_);
+    std::swap(packed_cols_, other.packed_cols_);
+    std::swap(is_single_precision_, other.is_single_precision_);
     std::swap(is_low_rank_, other.is_low_rank_);
     return *this;
   }
@@ -140,6 +258,15 @@ class TreeLeaf {
   // an actual matrix
   Eigen::Matrix<typename Derived::Scalar, Eigen::Dynamic, Eigen::Dynamic> F_,
       L_, R_;
+  // full matrix in reduced precision
+  Eigen::Matrix<typename SinglePrecision<typename Derived::Scalar>::type,
+                Eigen::Dynamic, Eigen::Dynamic>
+      F_single_;
+  // view on packed memory if the full matrix has been moved to an arena
+  typename Derived::Scalar *packed_F_;
+  int packed_rows_;
+  int packed_cols_;
+  bool is_single_precision_;
   bool is_low_rank_;
 };
 }  // namespace Bembel
@@ -70,8 +70,7 @@ Eigen::VectorXd getCoefficients(double precision) {
   unsigned int m, n, k;
   double scale, fac, norm;
 
-  GaussSquare<POINT_DEGREE> GS;
-  Eigen::MatrixXd xs = GS[POINT_DEGREE].xi_;
+  Eigen::MatrixXd xs = getGaussSquare<POINT_DEGREE>()[POINT_DEGREE].xi_;
   xs -= 0.5 * Eigen::MatrixXd::Ones(xs.rows(), xs.cols());
 
   Eigen::Vector3d ex(1.0, 0.0, 0.0);
@@ -347,8 +346,7 @@ double calculateFirstCoefficient(Eigen::VectorXd cs, unsigned int deg,
     Eigen::MatrixXd ps_l, Eigen::MatrixXd ps_f, Eigen::MatrixXd ps_b) {
   double res = 0.0;
 
-  GaussSquare<POINT_DEGREE> GS;
-  Eigen::VectorXd ws = GS[POINT_DEGREE].w_;
+  const Eigen::VectorXd &ws = getGaussSquare<POINT_DEGREE>()[POINT_DEGREE].w_;
 
   Eigen::VectorXd cs_tmp(cs.rows());
   cs_tmp.setZero();
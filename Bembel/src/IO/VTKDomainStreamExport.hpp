@@ -0,0 +1,229 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+#ifndef BEMBEL_SRC_IO_VTKDOMAINSTREAMEXPORT_HPP_
+#define BEMBEL_SRC_IO_VTKDOMAINSTREAMEXPORT_HPP_
+
+namespace Bembel {
+/**
+ * \ingroup IO
+ * \brief Streaming variant of the VTKDomainExport for very large grids.
+ *
+ * In contrast to the VTKDomainExport, the data sets are not evaluated when
+ * they are added. Instead, writeToFile() generates the grid points in chunks,
+ * evaluates every data set on one chunk at a time, e.g., by
+ * DiscretePotential::evaluate, and appends the results in binary format to the
+ * file. Thus, the memory consumption is bounded by the chunk size and not by
+ * the size of the grid. Optionally, the writing of a chunk overlaps with the
+ * evaluation of the next one.
+ **/
+class VTKDomainStreamExport {
+ public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// constructors
+  //////////////////////////////////////////////////////////////////////////////
+  VTKDomainStreamExport(const Eigen::VectorXd &x_vec,
+                        const Eigen::VectorXd &y_vec,
+                        const Eigen::VectorXd &z_vec) {
+    init_VTKDomainStreamExport(x_vec, y_vec, z_vec);
+  }
+  inline void init_VTKDomainStreamExport(const Eigen::VectorXd &x_vec,
+                                         const Eigen::VectorXd &y_vec,
+                                         const Eigen::VectorXd &z_vec) {
+    x_vec_ = x_vec;
+    y_vec_ = y_vec;
+    z_vec_ = z_vec;
+    number_of_points_ = std::size_t(x_vec_.rows()) * y_vec_.rows() *
+                        z_vec_.rows();
+    chunk_size_ = 1 << 16;
+    overlap_ = true;
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// setter
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Sets the number of grid points evaluated at once.
+   */
+  inline void set_chunk_size(int chunk_size) {
+    assert(chunk_size > 0 && "chunk size must be positive");
+    chunk_size_ = chunk_size;
+  }
+  /**
+   * \brief If true, a chunk is written while the next one is evaluated.
+   */
+  inline void set_overlap(bool overlap) { overlap_ = overlap; }
+  //////////////////////////////////////////////////////////////////////////////
+  /// methods
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Adds a data set which is evaluated while writing the file.
+   *
+   * \param name Name of the data set.
+   * \param number_of_components Either 1 for scalar or 3 for vector data.
+   * \param fun Maps a chunk of points, one point per row, to the values of
+   * the data set, one row per point.
+   */
+  inline void addDataSet(
+      const std::string &name, int number_of_components,
+      std::function<Eigen::MatrixXd(
+          const Eigen::Matrix<double, Eigen::Dynamic, 3> &)>
+          fun) {
+    assert(number_of_components == 1 || number_of_components == 3);
+    names_.push_back(name);
+    number_of_components_.push_back(number_of_components);
+    functions_.push_back(fun);
+    return;
+  }
+  /**
+   * \brief Writes the grid and all data sets as a VTK structured grid with
+   * appended raw binary data in Float32. The data is written in the byte
+   * order of the host, which is declared in the header of the file.
+   */
+  inline void writeToFile(const std::string &filename) const {
+    std::ofstream output(filename, std::ios::binary);
+    output << "<?xml version=\"1.0\"?>\n"
+              "<VTKFile type=\"StructuredGrid\" version=\"1.0\" "
+              "byte_order=\""
+           << (isLittleEndian() ? "LittleEndian" : "BigEndian")
+           << "\" header_type=\"UInt64\">\n"
+              "<StructuredGrid WholeExtent=\""
+           << extent()
+           << "\">\n"
+              "<Piece Extent=\""
+           << extent()
+           << "\">\n"
+              "<Points>\n"
+              "<DataArray type=\"Float32\" NumberOfComponents=\"3\" "
+              "format=\"appended\" offset=\"0\"/>\n"
+              "</Points>\n"
+              "<PointData>\n";
+    std::uint64_t offset = sizeof(std::uint64_t) + 3 * number_of_points_ * 4;
+    for (auto i = 0; i < names_.size(); ++i) {
+      output << "<DataArray type=\"Float32\" Name=\"" << names_[i]
+             << "\" NumberOfComponents=\"" << number_of_components_[i]
+             << "\" format=\"appended\" offset=\"" << offset << "\"/>\n";
+      offset += sizeof(std::uint64_t) +
+                number_of_components_[i] * number_of_points_ * 4;
+    }
+    output << "</PointData>\n"
+              "</Piece>\n"
+              "</StructuredGrid>\n"
+              "<AppendedData encoding=\"raw\">\n_";
+    std::uint64_t bytes = 3 * number_of_points_ * 4;
+    output.write(reinterpret_cast<const char *>(&bytes), sizeof(bytes));
+    streamDataSet(
+        [](const Eigen::Matrix<double, Eigen::Dynamic, 3> &points) {
+          return Eigen::MatrixXd(points);
+        },
+        3, &output);
+    for (auto i = 0; i < functions_.size(); ++i) {
+      bytes = number_of_components_[i] * number_of_points_ * 4;
+      output.write(reinterpret_cast<const char *>(&bytes), sizeof(bytes));
+      streamDataSet(functions_[i], number_of_components_[i], &output);
+    }
+    output << "\n</AppendedData>\n"
+              "</VTKFile>\n";
+    output.close();
+    return;
+  }
+  /**
+   * \brief Writes all data sets one after another as raw Float32 values in
+   * the byte order of the host without any header. The points are ordered as
+   * in the VTK file, i.e., the x-index runs fastest.
+   */
+  inline void writeRawToFile(const std::string &filename) const {
+    std::ofstream output(filename, std::ios::binary);
+    for (auto i = 0; i < functions_.size(); ++i)
+      streamDataSet(functions_[i], number_of_components_[i], &output);
+    output.close();
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// private members
+  //////////////////////////////////////////////////////////////////////////////
+ private:
+  /**
+   * \brief Returns true if the host stores numbers in little endian byte
+   * order.
+   */
+  static bool isLittleEndian() {
+    const std::uint16_t one = 1;
+    return *reinterpret_cast<const unsigned char *>(&one) == 1;
+  }
+  inline std::string extent() const {
+    return "0 " + std::to_string(x_vec_.rows() - 1) + " 0 " +
+           std::to_string(y_vec_.rows() - 1) + " 0 " +
+           std::to_string(z_vec_.rows() - 1);
+  }
+  /**
+   * \brief Evaluates fun chunk by chunk on the grid and appends the values to
+   * output. With overlap_, the buffer of a chunk is written asynchronously
+   * while the next chunk is evaluated, such that two buffers are in use.
+   */
+  inline void streamDataSet(
+      std::function<Eigen::MatrixXd(
+          const Eigen::Matrix<double, Eigen::Dynamic, 3> &)>
+          fun,
+      int number_of_components, std::ofstream *output) const {
+    std::vector<float> buffers[2];
+    std::future<void> pending;
+    Eigen::Matrix<double, Eigen::Dynamic, 3> points;
+    int chunk = 0;
+    for (std::size_t begin = 0; begin < number_of_points_;
+         begin += chunk_size_, ++chunk) {
+      const std::size_t end =
+          std::min(begin + chunk_size_, number_of_points_);
+      points.resize(end - begin, 3);
+      for (auto i = begin; i < end; ++i)
+        points.row(i - begin) << x_vec_(i % x_vec_.rows()),
+            y_vec_((i / x_vec_.rows()) % y_vec_.rows()),
+            z_vec_(i / (x_vec_.rows() * y_vec_.rows()));
+      Eigen::MatrixXd values = fun(points);
+      assert(values.rows() == points.rows() &&
+             values.cols() == number_of_components &&
+             "data set returns wrong number of values");
+      std::vector<float> &buffer = buffers[chunk % 2];
+      buffer.resize(values.size());
+      for (auto i = 0; i < values.rows(); ++i)
+        for (auto j = 0; j < number_of_components; ++j)
+          buffer[i * number_of_components + j] = values(i, j);
+      if (pending.valid()) pending.get();
+      auto write = [output, &buffer]() {
+        output->write(reinterpret_cast<const char *>(buffer.data()),
+                      buffer.size() * sizeof(float));
+      };
+      if (overlap_)
+        pending = std::async(std::launch::async, write);
+      else
+        write();
+    }
+    if (pending.valid()) pending.get();
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// member variables
+  //////////////////////////////////////////////////////////////////////////////
+  std::size_t number_of_points_;
+  std::size_t chunk_size_;
+  bool overlap_;
+  Eigen::VectorXd x_vec_;
+  Eigen::VectorXd y_vec_;
+  Eigen::VectorXd z_vec_;
+  std::vector<std::string> names_;
+  std::vector<int> number_of_components_;
+  std::vector<std::function<Eigen::MatrixXd(
+      const Eigen::Matrix<double, Eigen::Dynamic, 3> &)>>
+      functions_;
+};
+}  // namespace Bembel
+
+#endif  // BEMBEL_SRC_IO_VTKDOMAINSTREAMEXPORT_HPP_
@@ -39,48 +39,33 @@ class DiscreteLinearForm {
   //    compute
   //////////////////////////////////////////////////////////////////////////////
   /**
-   *    \todo Add inline commentary
+   * \brief Assembles the right hand side for the function of the linear form.
    **/
   void compute() {
-    GaussSquare<Constants::maximum_quadrature_degree> GS;
-    auto Q = GS[deg_];
-    SurfacePoint qp;
-    auto super_space = ansatz_space_.get_superspace();
-    const ElementTree &element_tree = super_space.get_mesh().get_element_tree();
-    auto number_of_elements = element_tree.get_number_of_elements();
-    auto polynomial_degree = super_space.get_polynomial_degree();
-    auto polynomial_degree_plus_one_squared =
-        (polynomial_degree + 1) * (polynomial_degree + 1);
-    const auto function_space_dimension =
-        getFunctionSpaceVectorDimension<LinearOperatorTraits<LinOp>::Form>();
-    Eigen::Matrix<typename LinearFormTraits<Derived>::Scalar, Eigen::Dynamic,
-                  function_space_dimension>
-        intval(polynomial_degree_plus_one_squared, function_space_dimension);
-    Eigen::Matrix<typename LinearFormTraits<Derived>::Scalar, Eigen::Dynamic,
-                  function_space_dimension>
-        disc_lf_matrix(polynomial_degree_plus_one_squared * number_of_elements,
-                       function_space_dimension);
-    disc_lf_matrix.setZero();
-    for (auto element = element_tree.cpbegin(); element != element_tree.cpend();
-         ++element) {
-      intval.setZero();
-      for (auto i = 0; i < Q.w_.size(); ++i) {
-        super_space.map2surface(*element, Q.xi_.col(i),
-                                element->get_h() * Q.w_(i), &qp);
-        lf_.evaluateIntegrand_impl(super_space, qp, &intval);
-      }
-      disc_lf_matrix.block(polynomial_degree_plus_one_squared * element->id_, 0,
-                           polynomial_degree_plus_one_squared,
-                           function_space_dimension) = intval;
-    }
-    disc_lf_ =
-        ansatz_space_.get_transformation_matrix().transpose() *
-        Eigen::Map<Eigen::Matrix<typename LinearOperatorTraits<LinOp>::Scalar,
-                                 Eigen::Dynamic, 1>>(
-            disc_lf_matrix.data(),
-            disc_lf_matrix.rows() * disc_lf_matrix.cols());
+    std::vector<const Derived *> linear_forms(1, std::addressof(lf_));
+    disc_lf_ = assemble(linear_forms).col(0);
     return;
   }
+  /**
+   * \brief Assembles the right hand sides for several functions at once and
+   * returns them column by column. The geometry is evaluated only once per
+   * quadrature point for all functions.
+   *
+   * \param functions Functions as accepted by the set_function() method of the
+   * linear form.
+   **/
+  template <typename Function>
+  Eigen::Matrix<typename LinearFormTraits<Derived>::Scalar, Eigen::Dynamic,
+                Eigen::Dynamic>
+  computeMultiple(const std::vector<Function> &functions) const {
+    std::vector<Derived> forms(functions.size(), lf_);
+    std::vector<const Derived *> linear_forms(functions.size());
+    for (auto k = 0; k < functions.size(); ++k) {
+      forms[k].set_function(functions[k]);
+      linear_forms[k] = std::addressof(forms[k]);
+    }
+    return assemble(linear_forms);
+  }
   //////////////////////////////////////////////////////////////////////////////
   //    setter
   //////////////////////////////////////////////////////////////////////////////
@@ -95,9 +80,68 @@ class DiscreteLinearForm {
     return disc_lf_;
   }
   //////////////////////////////////////////////////////////////////////////////
-  //    private member variables
+  //    private methods
   //////////////////////////////////////////////////////////////////////////////
  private:
+  /**
+   * \brief Assembles the right hand sides of several linear forms, one per
+   * column. The elements are processed in parallel, each writing to its own
+   * rows of the element-wise right hand sides.
+   **/
+  Eigen::Matrix<typename LinearFormTraits<Derived>::Scalar, Eigen::Dynamic,
+                Eigen::Dynamic>
+  assemble(const std::vector<const Derived *> &linear_forms) const {
+    typedef typename LinearFormTraits<Derived>::Scalar Scalar;
+    const Cubature &Q =
+        getGaussSquare<Constants::maximum_quadrature_degree>()[deg_];
+    const SuperSpace<LinOp> &super_space = ansatz_space_.get_superspace();
+    const ElementTree &element_tree = super_space.get_mesh().get_element_tree();
+    auto number_of_elements = element_tree.get_number_of_elements();
+    auto polynomial_degree = super_space.get_polynomial_degree();
+    auto polynomial_degree_plus_one_squared =
+        (polynomial_degree + 1) * (polynomial_degree + 1);
+    const auto function_space_dimension =
+        getFunctionSpaceVectorDimension<LinearOperatorTraits<LinOp>::Form>();
+    auto qps = super_space.get_mesh().get_quadrature_points(Q);
+    const int number_of_forms = linear_forms.size();
+    std::vector<const ElementTreeNode *> elements;
+    for (auto element = element_tree.cpbegin(); element != element_tree.cpend();
+         ++element)
+      elements.push_back(std::addressof(*element));
+    // the element-wise right hand sides of one linear form are stored
+    // component by component in one column
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> disc_lf_matrix(
+        polynomial_degree_plus_one_squared * number_of_elements *
+            function_space_dimension,
+        number_of_forms);
+#pragma omp parallel for schedule(dynamic)
+    for (auto e = 0; e < elements.size(); ++e) {
+      const ElementTreeNode &element = *elements[e];
+      std::vector<Eigen::Matrix<Scalar, Eigen::Dynamic,
+                                function_space_dimension>>
+          intval(number_of_forms,
+                 Eigen::Matrix<Scalar, Eigen::Dynamic,
+                               function_space_dimension>::Zero(
+                     polynomial_degree_plus_one_squared,
+                     function_space_dimension));
+      for (const auto &qp : (*qps)[element.id_]) {
+        for (auto k = 0; k < number_of_forms; ++k)
+          linear_forms[k]->evaluateIntegrand_impl(super_space, qp,
+                                                  &intval[k]);
+      }
+      for (auto k = 0; k < number_of_forms; ++k)
+        for (auto c = 0; c < function_space_dimension; ++c)
+          disc_lf_matrix.block(
+              polynomial_degree_plus_one_squared *
+                  (c * number_of_elements + element.id_),
+              k, polynomial_degree_plus_one_squared, 1) = intval[k].col(c);
+    }
+    return ansatz_space_.get_transformation_matrix().transpose() *
+           disc_lf_matrix;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  //    private member variables
+  //////////////////////////////////////////////////////////////////////////////
   int deg_;
   Derived lf_;
   Eigen::Matrix<typename LinearFormTraits<Derived>::Scalar, Eigen::Dynamic, 1>
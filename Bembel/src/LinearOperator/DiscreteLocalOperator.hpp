@@ -20,11 +20,11 @@ namespace Bembel {
  */
 template <typename Derived>
 struct DiscreteLocalOperatorComputer {
+  typedef typename LinearOperatorTraits<Derived>::Scalar Scalar;
   DiscreteLocalOperatorComputer() {}
-  static void compute(
-      Eigen::SparseMatrix<typename LinearOperatorTraits<Derived>::Scalar>
-          *disc_op,
-      const Derived &lin_op, const AnsatzSpace<Derived> &ansatz_space) {
+  static void compute(Eigen::SparseMatrix<Scalar> *disc_op,
+                      const Derived &lin_op,
+                      const AnsatzSpace<Derived> &ansatz_space) {
     // Extract numbers
     const auto &super_space = ansatz_space.get_superspace();
     const auto &element_tree = super_space.get_mesh().get_element_tree();
@@ -34,55 +34,126 @@ struct DiscreteLocalOperatorComputer {
     const auto polynomial_degree = super_space.get_polynomial_degree();
     const auto polynomial_degree_plus_one_squared =
         (polynomial_degree + 1) * (polynomial_degree + 1);
+    const int block_size =
+        vector_dimension * polynomial_degree_plus_one_squared;
+    const int number_of_columns = block_size * number_of_elements;
 
     // Quadrature
-    GaussSquare<Constants::maximum_quadrature_degree> GS;
     auto ffield_deg = lin_op.get_FarfieldQuadratureDegree(polynomial_degree);
-    auto Q = GS[ffield_deg];
+    const Cubature &Q =
+        getGaussSquare<Constants::maximum_quadrature_degree>()[ffield_deg];
 
-    // Triplets
-    typedef Eigen::Triplet<typename LinearOperatorTraits<Derived>::Scalar> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(polynomial_degree_plus_one_squared *
-                        polynomial_degree_plus_one_squared *
-                        number_of_elements * vector_dimension);
+    // The element matrices only couple the shape functions on the same
+    // element. Thus, every column of the discontinuous matrix has exactly
+    // block_size entries, whose row indices are ascending in the order of the
+    // element matrix, and the compressed storage can be filled in place.
+    Eigen::SparseMatrix<Scalar> local_matrix(number_of_columns,
+                                             number_of_columns);
+    local_matrix.resizeNonZeros(block_size * number_of_columns);
+    for (int col = 0; col <= number_of_columns; ++col)
+      local_matrix.outerIndexPtr()[col] = block_size * col;
+    std::vector<const ElementTreeNode *> elements;
+    elements.reserve(number_of_elements);
+    for (auto element = element_tree.cpbegin(); element != element_tree.cpend();
+         ++element)
+      elements.push_back(std::addressof(*element));
 
     // Iterate over elements
-    for (auto element = element_tree.cpbegin(); element != element_tree.cpend();
-         ++element) {
-      Eigen::Matrix<typename LinearOperatorTraits<Derived>::Scalar,
-                    Eigen::Dynamic, Eigen::Dynamic>
-          intval(vector_dimension * polynomial_degree_plus_one_squared,
-                 vector_dimension * polynomial_degree_plus_one_squared);
-      intval.setZero();
-      // Iterate over quadrature points
-      for (auto i = 0; i < Q.w_.size(); ++i) {
-        SurfacePoint qp;
-        super_space.map2surface(*element, Q.xi_.col(i), Q.w_(i), &qp);
-        lin_op.evaluateIntegrand(super_space, qp, qp, &intval);
-      }
-      // Transform local element matrices to triplets
+#pragma omp parallel for schedule(dynamic)
+    for (int k = 0; k < number_of_elements; ++k) {
+      const ElementTreeNode &element = *(elements[k]);
+      Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> intval(block_size,
+                                                                   block_size);
+      computeElementMatrix(lin_op, super_space, element, Q, &intval);
+      // Copy the local element matrix into the columns of the element
       for (auto i = 0; i < vector_dimension; ++i)
-        for (auto j = 0; j < vector_dimension; ++j)
-          for (auto ii = 0; ii < polynomial_degree_plus_one_squared; ++ii)
-            for (auto jj = 0; jj < polynomial_degree_plus_one_squared; ++jj)
-              tripletList.push_back(
-                  T(polynomial_degree_plus_one_squared *
-                            (j * number_of_elements + element->id_) +
-                        jj,
-                    polynomial_degree_plus_one_squared *
-                            (i * number_of_elements + element->id_) +
-                        ii,
-                    intval(j * polynomial_degree_plus_one_squared + jj,
-                           i * polynomial_degree_plus_one_squared + ii)));
+        for (auto ii = 0; ii < polynomial_degree_plus_one_squared; ++ii) {
+          const int col = polynomial_degree_plus_one_squared *
+                              (i * number_of_elements + element.id_) +
+                          ii;
+          int *rows = local_matrix.innerIndexPtr() + block_size * col;
+          Scalar *values = local_matrix.valuePtr() + block_size * col;
+          for (auto j = 0; j < vector_dimension; ++j)
+            for (auto jj = 0; jj < polynomial_degree_plus_one_squared; ++jj) {
+              rows[j * polynomial_degree_plus_one_squared + jj] =
+                  polynomial_degree_plus_one_squared *
+                      (j * number_of_elements + element.id_) +
+                  jj;
+              values[j * polynomial_degree_plus_one_squared + jj] =
+                  intval(j * polynomial_degree_plus_one_squared + jj,
+                         i * polynomial_degree_plus_one_squared + ii);
+            }
+        }
+    }
+    galerkinProjection(local_matrix, ansatz_space.get_transformation_matrix(),
+                       disc_op);
+    return;
+  }
+  /**
+   *  \brief Computes the matrix of the local operator with respect to the
+   *  shape functions on a single element.
+   */
+  static void computeElementMatrix(
+      const Derived &lin_op, const SuperSpace<Derived> &super_space,
+      const ElementTreeNode &element, const Cubature &Q,
+      Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> *intval) {
+    intval->setZero();
+    // Iterate over quadrature points
+    for (auto i = 0; i < Q.w_.size(); ++i) {
+      SurfacePoint qp;
+      super_space.map2surface(element, Q.xi_.col(i), Q.w_(i), &qp);
+      lin_op.evaluateIntegrand(super_space, qp, qp, intval);
+    }
+    return;
+  }
+  /**
+   *  \brief Computes projector^T * local_matrix * projector.
+   *
+   *  The columns of the projector are split into blocks, whose products are
+   *  computed in parallel and afterwards concatenated in the compressed
+   *  storage of the result.
+   */
+  static void galerkinProjection(
+      const Eigen::SparseMatrix<Scalar> &local_matrix,
+      const Eigen::SparseMatrix<double> &projector,
+      Eigen::SparseMatrix<Scalar> *disc_op) {
+    // number of columns of the projector per parallel task
+    const int projection_block_size = 256;
+    const int number_of_dofs = projector.cols();
+    const int number_of_blocks =
+        (number_of_dofs + projection_block_size - 1) / projection_block_size;
+    const Eigen::SparseMatrix<double> projector_transposed =
+        projector.transpose();
+    std::vector<Eigen::SparseMatrix<Scalar>> blocks(number_of_blocks);
+#pragma omp parallel for schedule(dynamic)
+    for (int k = 0; k < number_of_blocks; ++k) {
+      const int first_col = k * projection_block_size;
+      const int cols =
+          std::min(projection_block_size, number_of_dofs - first_col);
+      const Eigen::SparseMatrix<Scalar> rhs =
+          local_matrix * projector.middleCols(first_col, cols);
+      blocks[k] = projector_transposed * rhs;
+      blocks[k].makeCompressed();
+    }
+    std::vector<int> offsets(number_of_blocks + 1, 0);
+    for (int k = 0; k < number_of_blocks; ++k)
+      offsets[k + 1] = offsets[k] + blocks[k].nonZeros();
+    disc_op->resize(number_of_dofs, number_of_dofs);
+    disc_op->resizeNonZeros(offsets[number_of_blocks]);
+    disc_op->outerIndexPtr()[number_of_dofs] = offsets[number_of_blocks];
+#pragma omp parallel for
+    for (int k = 0; k < number_of_blocks; ++k) {
+      const int first_col = k * projection_block_size;
+      for (int col = 0; col < blocks[k].cols(); ++col)
+        disc_op->outerIndexPtr()[first_col + col] =
+            offsets[k] + blocks[k].outerIndexPtr()[col];
+      std::copy(blocks[k].innerIndexPtr(),
+                blocks[k].innerIndexPtr() + blocks[k].nonZeros(),
+                disc_op->innerIndexPtr() + offsets[k]);
+      std::copy(blocks[k].valuePtr(),
+                blocks[k].valuePtr() + blocks[k].nonZeros(),
+                disc_op->valuePtr() + offsets[k]);
     }
-    disc_op->resize(vector_dimension * polynomial_degree_plus_one_squared *
-                        number_of_elements,
-                    vector_dimension * polynomial_degree_plus_one_squared *
-                        number_of_elements);
-    disc_op->setFromTriplets(tripletList.begin(), tripletList.end());
-    const auto &projector = ansatz_space.get_transformation_matrix();
-    disc_op[0] = projector.transpose() * (disc_op[0] * projector);
     return;
   }
 };
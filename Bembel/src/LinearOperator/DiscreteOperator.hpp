@@ -31,7 +31,8 @@ struct DiscreteOperatorComputer<
   static void compute(
       Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> *disc_op,
       const Derived &lin_op, const AnsatzSpace<Derived> &ansatz_space) {
-    GaussSquare<Constants::maximum_quadrature_degree> GS;
+    const GaussSquare<Constants::maximum_quadrature_degree> &GS =
+        getGaussSquare<Constants::maximum_quadrature_degree>();
     const SuperSpace<Derived> &super_space = ansatz_space.get_superspace();
     const ElementTree &element_tree = super_space.get_mesh().get_element_tree();
     auto number_of_elements = element_tree.get_number_of_elements();
@@ -42,11 +43,23 @@ struct DiscreteOperatorComputer<
         (polynomial_degree + 1) * (polynomial_degree + 1);
     auto ffield_deg = lin_op.get_FarfieldQuadratureDegree(polynomial_degree);
     auto ffield_qnodes =
-        DuffyTrick::computeFfieldQnodes(super_space, GS[ffield_deg]);
+        super_space.get_mesh().get_quadrature_points(GS[ffield_deg]);
     disc_op->resize(vector_dimension * polynomial_degree_plus_one_squared *
                         number_of_elements,
                     vector_dimension * polynomial_degree_plus_one_squared *
                         number_of_elements);
+    if (lin_op.get_nearfield_quadrature_tolerance() > 0) {
+      std::vector<std::pair<const ElementTreeNode *, const ElementTreeNode *>>
+          pairs;
+      for (auto element1 = element_tree.cpbegin();
+           element1 != element_tree.cpend(); ++element1)
+        for (auto element2 = element_tree.cpbegin();
+             element2 != element_tree.cpend(); ++element2)
+          pairs.push_back(std::make_pair(std::addressof(*element1),
+                                         std::addressof(*element2)));
+      DuffyTrick::computeNearfieldQuadratureDegrees(lin_op, super_space, pairs,
+                                                    GS, *ffield_qnodes);
+    }
 #pragma omp parallel
     {
 #pragma omp single
@@ -62,7 +75,8 @@ struct DiscreteOperatorComputer<
                   vector_dimension * polynomial_degree_plus_one_squared);
               DuffyTrick::evaluateBilinearForm(
                   lin_op, super_space, *element1, *element2, GS,
-                  ffield_qnodes[element1->id_], ffield_qnodes[element2->id_],
+                  (*ffield_qnodes)[element1->id_],
+                  (*ffield_qnodes)[element2->id_],
                   &intval);
               for (auto i = 0; i < vector_dimension; ++i)
                 for (auto j = 0; j < vector_dimension; ++j)
@@ -80,8 +94,15 @@ struct DiscreteOperatorComputer<
           }
       }
     }
-    auto projector = ansatz_space.get_transformation_matrix();
-    disc_op[0] = projector.transpose() * (disc_op[0] * projector);
+    const StructuredTransformation &structured_transformation =
+        ansatz_space.get_structured_transformation();
+    if (structured_transformation.is_preferable()) {
+      structured_transformation.projectDense(disc_op);
+    } else {
+      const Eigen::SparseMatrix<double> &projector =
+          ansatz_space.get_transformation_matrix();
+      disc_op[0] = projector.transpose() * (disc_op[0] * projector);
+    }
     return;
   }
 };
@@ -133,6 +154,7 @@ class DiscreteOperator {
   //    getter
   //////////////////////////////////////////////////////////////////////////////
   const MatrixFormat &get_discrete_operator() const { return disc_op_; }
+  MatrixFormat &get_discrete_operator() { return disc_op_; }
   const Derived &get_linear_operator() const { return lin_op_; }
   Derived &get_linear_operator() { return lin_op_; }
   //////////////////////////////////////////////////////////////////////////////
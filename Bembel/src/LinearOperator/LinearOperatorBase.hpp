@@ -12,6 +12,45 @@
 #define BEMBEL_SRC_LINEAROPERATOR_LINEAROPERATORBASE_HPP_
 
 namespace Bembel {
+/**
+ * \ingroup LinearOperator
+ * \brief Stores the near-field quadrature degrees chosen by the adaptive
+ * quadrature of DuffyTrick::evaluateBilinearForm for classes of element
+ * pairs.
+ *
+ * A class is identified by the type of the singularity, see
+ * DuffyTrick::compareElements, the level of the elements, the distance of the
+ * elements relative to their size and the polynomial degree of the ansatz
+ * space. The degrees are determined by
+ * DuffyTrick::computeNearfieldQuadratureDegrees before the assembly, which
+ * only reads them. Hence, the methods are not synchronized.
+ */
+class NearfieldQuadratureDegrees {
+ public:
+  typedef std::array<int, 4> Key;
+  /**
+   * \brief Returns the degree stored for the class key or -1 if no degree has
+   * been chosen yet.
+   */
+  int get_degree(const Key &key) const {
+    auto it = degrees_.find(key);
+    return it == degrees_.end() ? -1 : it->second;
+  }
+  /**
+   * \brief Stores the degree for the class key.
+   */
+  void set_degree(const Key &key, int degree) {
+    degrees_[key] = degree;
+    return;
+  }
+  /**
+   * \brief Returns the number of classes for which a degree is stored.
+   */
+  int get_number_of_classes() const { return degrees_.size(); }
+
+ private:
+  std::map<Key, int> degrees_;
+};
 /**
  * \ingroup LinearOperator
  * \brief linear operator base class. this serves as a common interface for
@@ -23,7 +62,10 @@ namespace Bembel {
 template <typename Derived>
 struct LinearOperatorBase {
   // Constructors
-  LinearOperatorBase() {}
+  LinearOperatorBase()
+      : nearfield_quadrature_tolerance_(0),
+        nearfield_quadrature_degrees_(
+            std::make_shared<NearfieldQuadratureDegrees>()) {}
   // the user has to provide the implementation of this function, which
   // is able to evaluate the integrand of the Galerkin formulation in a
   // pair of quadrature points represented as a
@@ -87,10 +129,37 @@ struct LinearOperatorBase {
 
     return 0.5 * numerator / denominator;
   }
+  /**
+   * \brief Enables the adaptive near-field quadrature for a positive
+   * tolerance and disables it otherwise.
+   *
+   * In adaptive mode, DuffyTrick::evaluateBilinearForm chooses the smallest
+   * quadrature degree for which the difference to the next higher degree is
+   * below tolerance times the largest entry of the element matrix. The choice
+   * is made once per class of element pairs before the assembly, see
+   * DuffyTrick::computeNearfieldQuadratureDegrees, and then used for all pairs
+   * of that class. Copies of the operator share the chosen degrees.
+   **/
+  void set_nearfield_quadrature_tolerance(double tolerance) {
+    nearfield_quadrature_tolerance_ = tolerance;
+    nearfield_quadrature_degrees_ =
+        std::make_shared<NearfieldQuadratureDegrees>();
+    return;
+  }
+  double get_nearfield_quadrature_tolerance() const {
+    return nearfield_quadrature_tolerance_;
+  }
+  NearfieldQuadratureDegrees &get_nearfield_quadrature_degrees() const {
+    return *nearfield_quadrature_degrees_;
+  }
   // pointer to the derived object
   Derived &derived() { return *static_cast<Derived *>(this); }
   // const pointer to the derived object
   const Derived &derived() const { return *static_cast<const Derived *>(this); }
+
+ private:
+  double nearfield_quadrature_tolerance_;
+  std::shared_ptr<NearfieldQuadratureDegrees> nearfield_quadrature_degrees_;
 };
 }  // namespace Bembel
 #endif  // BEMBEL_SRC_LINEAROPERATOR_LINEAROPERATORBASE_HPP_
@@ -0,0 +1,274 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+#ifndef BEMBEL_SRC_LINEAROPERATOR_MATRIXFREELOCALOPERATOR_HPP_
+#define BEMBEL_SRC_LINEAROPERATOR_MATRIXFREELOCALOPERATOR_HPP_
+
+/**
+ *  \class MatrixFreeLocalOperator
+ *  \brief Matrix-free representation of a discrete local operator, which
+ *  extends the EigenBase class.
+ *
+ *  Only the element matrices with respect to the discontinuous shape functions
+ *  are stored. The matrix-vector multiplication maps the coefficients to the
+ *  discontinuous space by the transformation matrix, applies the element
+ *  matrices in parallel and maps the result back. The transformation matrix
+ *  and its structured representation are shared with the ansatz space and the
+ *  latter is used for both maps if it is exact. As for the H2Matrix, the
+ *  traits of an Eigen::SparseMatrix are inherited, such that the class can be
+ *  used with the Eigen iterative solvers, e.g., with the ConjugateGradient
+ *  and the IdentityPreconditioner.
+ **/
+namespace Eigen {
+/// forward definition of the MatrixFreeLocalOperator class to define traits
+template <typename ScalarT>
+class MatrixFreeLocalOperator;
+namespace internal {
+template <typename ScalarT>
+struct traits<MatrixFreeLocalOperator<ScalarT>>
+    : public traits<SparseMatrix<ScalarT>> {};
+}  // namespace internal
+
+// actual definition of the class
+template <typename ScalarT>
+class MatrixFreeLocalOperator
+    : public EigenBase<MatrixFreeLocalOperator<ScalarT>> {
+ public:
+  //////////////////////////////////////////////////////////////////////////////
+  /// Eigen related things
+  //////////////////////////////////////////////////////////////////////////////
+  // Required typedefs, constants and so on.
+  typedef ScalarT Scalar;
+  typedef typename NumTraits<ScalarT>::Real RealScalar;
+  typedef int StorageIndex;
+  enum {
+    ColsAtCompileTime = Dynamic,
+    MaxColsAtCompileTime = Dynamic,
+    IsRowMajor = false
+  };
+  // Minimum specialisation of EigenBase methods
+  Index rows() const { return transformation_matrix_->cols(); }
+  Index cols() const { return transformation_matrix_->cols(); }
+  // Definition of the matrix multiplication
+  template <typename Rhs>
+  Product<MatrixFreeLocalOperator, Rhs, AliasFreeProduct> operator*(
+      const MatrixBase<Rhs> &x) const {
+    return Product<MatrixFreeLocalOperator, Rhs, AliasFreeProduct>(
+        *this, x.derived());
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// constructors
+  //////////////////////////////////////////////////////////////////////////////
+  MatrixFreeLocalOperator()
+      : transformation_matrix_(
+            std::make_shared<const Eigen::SparseMatrix<double>>()),
+        structured_transformation_(
+            std::make_shared<const Bembel::StructuredTransformation>()),
+        number_of_elements_(0),
+        vector_dimension_(0),
+        polynomial_degree_plus_one_squared_(0) {}
+  /**
+   * \brief Computes the element matrices of the local operator lin_op on the
+   * AnsatzSpace ansatz_space. The transformation matrix and its structured
+   * representation are shared with the ansatz space.
+   */
+  template <typename Derived>
+  void init_MatrixFreeLocalOperator(
+      const Derived &lin_op, const Bembel::AnsatzSpace<Derived> &ansatz_space) {
+    transformation_matrix_ = ansatz_space.get_shared_transformation_matrix();
+    structured_transformation_ =
+        ansatz_space.get_shared_structured_transformation();
+    const auto &super_space = ansatz_space.get_superspace();
+    const auto &element_tree = super_space.get_mesh().get_element_tree();
+    const int polynomial_degree = super_space.get_polynomial_degree();
+    number_of_elements_ = element_tree.get_number_of_elements();
+    vector_dimension_ = Bembel::getFunctionSpaceVectorDimension<
+        Bembel::LinearOperatorTraits<Derived>::Form>();
+    polynomial_degree_plus_one_squared_ =
+        (polynomial_degree + 1) * (polynomial_degree + 1);
+    const int block_size =
+        vector_dimension_ * polynomial_degree_plus_one_squared_;
+
+    const Bembel::Cubature &Q = Bembel::getGaussSquare<
+        Bembel::Constants::maximum_quadrature_degree>()
+        [lin_op.get_FarfieldQuadratureDegree(polynomial_degree)];
+    std::vector<const Bembel::ElementTreeNode *> elements;
+    elements.reserve(number_of_elements_);
+    for (auto element = element_tree.cpbegin(); element != element_tree.cpend();
+         ++element)
+      elements.push_back(std::addressof(*element));
+    element_matrices_.resize(number_of_elements_);
+#pragma omp parallel for schedule(dynamic)
+    for (int k = 0; k < number_of_elements_; ++k) {
+      Matrix<Scalar, Dynamic, Dynamic> &intval =
+          element_matrices_[elements[k]->id_];
+      intval.resize(block_size, block_size);
+      Bembel::DiscreteLocalOperatorComputer<Derived>::computeElementMatrix(
+          lin_op, super_space, *(elements[k]), Q, &intval);
+    }
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// methods
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * \brief Applies the block diagonal matrix of the element matrices to a
+   * vector of coefficients with respect to the discontinuous shape functions.
+   */
+  template <typename RhsType, typename ResType>
+  void applyElementMatrices(const RhsType &rhs, ResType *res) const {
+    const int block_size =
+        vector_dimension_ * polynomial_degree_plus_one_squared_;
+#pragma omp parallel for
+    for (int k = 0; k < number_of_elements_; ++k) {
+      Matrix<Scalar, Dynamic, 1> local_rhs(block_size);
+      for (int i = 0; i < vector_dimension_; ++i)
+        local_rhs.segment(i * polynomial_degree_plus_one_squared_,
+                          polynomial_degree_plus_one_squared_) =
+            rhs.segment(polynomial_degree_plus_one_squared_ *
+                            (i * number_of_elements_ + k),
+                        polynomial_degree_plus_one_squared_);
+      const Matrix<Scalar, Dynamic, 1> local_res =
+          element_matrices_[k] * local_rhs;
+      for (int i = 0; i < vector_dimension_; ++i)
+        res->segment(polynomial_degree_plus_one_squared_ *
+                         (i * number_of_elements_ + k),
+                     polynomial_degree_plus_one_squared_) =
+            local_res.segment(i * polynomial_degree_plus_one_squared_,
+                              polynomial_degree_plus_one_squared_);
+    }
+    return;
+  }
+  /**
+   * \brief Computes out = T^T * in for the transformation matrix T. Since T is
+   * stored column-major, every entry of out is computed independently from a
+   * column of T, which is done in parallel.
+   */
+  template <typename VecScalar>
+  void applyTransposedTransformation(
+      const Matrix<VecScalar, Dynamic, 1> &in,
+      Matrix<VecScalar, Dynamic, 1> *out) const {
+    const SparseMatrix<double> &T = *transformation_matrix_;
+    out->resize(T.cols());
+#pragma omp parallel for
+    for (int j = 0; j < T.cols(); ++j) {
+      VecScalar sum(0);
+      for (SparseMatrix<double>::InnerIterator it(T, j); it; ++it)
+        sum += it.value() * in(it.row());
+      (*out)(j) = sum;
+    }
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// getter
+  //////////////////////////////////////////////////////////////////////////////
+  const SparseMatrix<double> &get_transformation_matrix() const {
+    return *transformation_matrix_;
+  }
+  const Bembel::StructuredTransformation &get_structured_transformation()
+      const {
+    return *structured_transformation_;
+  }
+  const std::vector<Matrix<Scalar, Dynamic, Dynamic>> &get_element_matrices()
+      const {
+    return element_matrices_;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  /// private members
+  //////////////////////////////////////////////////////////////////////////////
+ private:
+  std::shared_ptr<const SparseMatrix<double>> transformation_matrix_;
+  std::shared_ptr<const Bembel::StructuredTransformation>
+      structured_transformation_;
+  std::vector<Matrix<Scalar, Dynamic, Dynamic>> element_matrices_;
+  int number_of_elements_;
+  int vector_dimension_;
+  int polynomial_degree_plus_one_squared_;
+};
+
+namespace internal {
+/**
+ * \brief Implementation of the product of a MatrixFreeLocalOperator with a
+ * dense matrix or vector.
+ */
+template <typename ScalarT, typename Rhs, int ProductType>
+struct generic_product_impl<MatrixFreeLocalOperator<ScalarT>, Rhs, SparseShape,
+                            DenseShape, ProductType>
+    : generic_product_impl_base<
+          MatrixFreeLocalOperator<ScalarT>, Rhs,
+          generic_product_impl<MatrixFreeLocalOperator<ScalarT>, Rhs>> {
+  typedef typename Product<MatrixFreeLocalOperator<ScalarT>, Rhs>::Scalar
+      Scalar;
+
+  template <typename Dest>
+  static void scaleAndAddTo(Dest &dst,
+                            const MatrixFreeLocalOperator<ScalarT> &lhs,
+                            const Rhs &rhs, const Scalar &alpha) {
+    // the structured transformation is applied in parallel if it coincides
+    // with the transformation matrix
+    const Bembel::StructuredTransformation &structured_transformation =
+        lhs.get_structured_transformation();
+    const bool structured = structured_transformation.is_exact();
+    for (Index c = 0; c < rhs.cols(); ++c) {
+      Matrix<Scalar, Dynamic, 1> local_rhs;
+      if (structured)
+        structured_transformation.apply<Scalar>(rhs.col(c), &local_rhs);
+      else
+        local_rhs = lhs.get_transformation_matrix() * rhs.col(c);
+      Matrix<Scalar, Dynamic, 1> local_res(local_rhs.size());
+      lhs.applyElementMatrices(local_rhs, &local_res);
+      Matrix<Scalar, Dynamic, 1> res;
+      if (structured)
+        structured_transformation.applyTranspose<Scalar>(local_res, &res);
+      else
+        lhs.applyTransposedTransformation(local_res, &res);
+      dst.col(c) += alpha * res;
+    }
+    return;
+  }
+};
+}  // namespace internal
+}  // namespace Eigen
+
+namespace Bembel {
+/**
+ *  \brief Helper struct that is used in order to partially specialise the
+ *         compute routine of DiscreteOperator for the
+ *         Eigen::MatrixFreeLocalOperator format
+ */
+template <typename Derived>
+struct DiscreteOperatorComputer<
+    Eigen::MatrixFreeLocalOperator<
+        typename LinearOperatorTraits<Derived>::Scalar>,
+    Derived> {
+  DiscreteOperatorComputer() {}
+  static void compute(
+      Eigen::MatrixFreeLocalOperator<
+          typename LinearOperatorTraits<Derived>::Scalar> *disc_op,
+      const Derived &lin_op, const AnsatzSpace<Derived> &ansatz_space) {
+    disc_op->init_MatrixFreeLocalOperator(lin_op, ansatz_space);
+    return;
+  }
+};
+
+/**
+ *  \ingroup LocalOperator
+ *  \brief MatrixFreeDiscreteLocalOperator
+ *         Specialization of the DiscreteOperator class, which applies the
+ *         element matrices of a local operator without assembling the sparse
+ *         matrix
+ **/
+template <typename Derived>
+using MatrixFreeDiscreteLocalOperator = DiscreteOperator<
+    Eigen::MatrixFreeLocalOperator<
+        typename LinearOperatorTraits<Derived>::Scalar>,
+    Derived>;
+}  // namespace Bembel
+#endif  // BEMBEL_SRC_LINEAROPERATOR_MATRIXFREELOCALOPERATOR_HPP_
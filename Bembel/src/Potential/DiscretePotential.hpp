@@ -23,8 +23,14 @@ class DiscretePotential {
   //////////////////////////////////////////////////////////////////////////////
   //    constructors
   //////////////////////////////////////////////////////////////////////////////
-  DiscretePotential() {}
-  explicit DiscretePotential(const AnsatzSpace<LinOp> &ansatz_space) {
+  DiscretePotential()
+      : number_of_interpolation_points_(0),
+        eta_(1.),
+        quadrature_tolerance_(0) {}
+  explicit DiscretePotential(const AnsatzSpace<LinOp> &ansatz_space)
+      : number_of_interpolation_points_(0),
+        eta_(1.),
+        quadrature_tolerance_(0) {
     init_DiscretePotential(ansatz_space);
   }
   //////////////////////////////////////////////////////////////////////////////
@@ -47,21 +53,17 @@ class DiscretePotential {
                     typename PotentialTraits<Derived>::Scalar>::Scalar,
                 Eigen::Dynamic, PotentialTraits<Derived>::OutputSpaceDimension>
   evaluate(const Eigen::Matrix<double, Eigen::Dynamic, 3> &points) {
-    auto FunctionSpaceVectorDimension =
-        getFunctionSpaceVectorDimension<LinearOperatorTraits<LinOp>::Form>();
-    auto OutputDimension = PotentialTraits<Derived>::OutputSpaceDimension;
-
-    GaussSquare<Constants::maximum_quadrature_degree> GS;
-    auto Q = GS[deg_];
-
-    auto super_space = ansatz_space_.get_superspace();
-
+    if (number_of_interpolation_points_ > 0)
+      return evaluateInterpolated(points);
+    const SuperSpace<LinOp> &super_space = ansatz_space_.get_superspace();
     const ElementTree &element_tree = super_space.get_mesh().get_element_tree();
-    auto number_of_elements = element_tree.get_number_of_elements();
 
-    auto polynomial_degree = super_space.get_polynomial_degree();
-    auto polynomial_degree_plus_one_squared =
-        (polynomial_degree + 1) * (polynomial_degree + 1);
+    // quadrature points of all elements, indexed by the quadrature degree and
+    // the element id
+    const GaussSquare<Constants::maximum_quadrature_degree> &GS =
+        getGaussSquare<Constants::maximum_quadrature_degree>();
+    std::vector<std::vector<ElementSurfacePoints>> qps =
+        computeQuadratureRules(GS);
 
     Eigen::Matrix<typename PotentialReturnScalar<
                       typename LinearOperatorTraits<LinOp>::Scalar,
@@ -73,38 +75,344 @@ class DiscretePotential {
                      PotentialTraits<Derived>::OutputSpaceDimension);
     potential.setZero();
 
-#pragma omp parallel
-    {
-      Eigen::Matrix<typename PotentialReturnScalar<
-                        typename LinearOperatorTraits<LinOp>::Scalar,
-                        typename PotentialTraits<Derived>::Scalar>::Scalar,
-                    Eigen::Dynamic,
-                    PotentialTraits<Derived>::OutputSpaceDimension>
-          my_potential;
-      my_potential.resize(points.rows(),
-                          PotentialTraits<Derived>::OutputSpaceDimension);
-      my_potential.setZero();
+    // every thread owns tiles of points and writes to them only
+    const int number_of_tiles =
+        (points.rows() + Constants::potential_tile_size - 1) /
+        Constants::potential_tile_size;
+#pragma omp parallel for schedule(dynamic)
+    for (auto tile = 0; tile < number_of_tiles; ++tile) {
+      const int begin = tile * Constants::potential_tile_size;
+      const int end = std::min(begin + Constants::potential_tile_size,
+                               static_cast<int>(points.rows()));
       for (auto element = element_tree.cpbegin();
-           element != element_tree.cpend(); ++element) {
-#pragma omp single nowait
-        {
-          SurfacePoint qp;
-          for (auto j = 0; j < Q.w_.size(); ++j) {
-            super_space.map2surface(
-                *element, Q.xi_.col(j),
-                element->get_h() * element->get_h() * Q.w_(j), &qp);
-            for (auto i = 0; i < points.rows(); ++i) {
-              my_potential.row(i) += pot_.evaluateIntegrand_impl(
-                  fun_ev_, *element, points.row(i), qp);
+           element != element_tree.cpend(); ++element)
+        for (auto i = begin; i < end; ++i)
+          potential.row(i) +=
+              integrateElement(GS, qps, *element, points.row(i).transpose());
+    }
+    return potential;
+  }
+  /**
+   * \brief Evaluates the potential by interpolating the far field.
+   *
+   * The evaluation points are clustered by a PointClusterTree and paired with
+   * the clusters of the ElementTree. If a point cluster and an element cluster
+   * are admissible, i.e., radius of the point cluster < eta * distance of the
+   * clusters, the potential of the element cluster is evaluated in tensor
+   * Chebychev points in the bounding box of the point cluster and
+   * interpolated to the points. All remaining pairs are integrated directly.
+   * The number of kernel evaluations then scales almost linearly in the number
+   * of points instead of like points x elements.
+   */
+  Eigen::Matrix<typename PotentialReturnScalar<
+                    typename LinearOperatorTraits<LinOp>::Scalar,
+                    typename PotentialTraits<Derived>::Scalar>::Scalar,
+                Eigen::Dynamic, PotentialTraits<Derived>::OutputSpaceDimension>
+  evaluateInterpolated(
+      const Eigen::Matrix<double, Eigen::Dynamic, 3> &points) {
+    typedef typename PotentialReturnScalar<
+        typename LinearOperatorTraits<LinOp>::Scalar,
+        typename PotentialTraits<Derived>::Scalar>::Scalar PotentialScalar;
+    typedef Eigen::Matrix<PotentialScalar, Eigen::Dynamic,
+                          PotentialTraits<Derived>::OutputSpaceDimension>
+        PotentialMatrix;
+    const int n = number_of_interpolation_points_;
+
+    const SuperSpace<LinOp> &super_space = ansatz_space_.get_superspace();
+    const ElementTree &element_tree = super_space.get_mesh().get_element_tree();
+
+    // quadrature points of all elements, indexed by the quadrature degree and
+    // the element id
+    const GaussSquare<Constants::maximum_quadrature_degree> &GS =
+        getGaussSquare<Constants::maximum_quadrature_degree>();
+    std::vector<std::vector<ElementSurfacePoints>> qps =
+        computeQuadratureRules(GS);
+
+    // cluster the points such that a leaf is not larger than an interpolation
+    PointClusterTree point_tree(points, n * n * n);
+    const std::vector<PointCluster> &clusters = point_tree.get_clusters();
+    const std::vector<int> &indices = point_tree.get_indices();
+
+    // number of interpolation points per direction, degenerated directions of
+    // the bounding box get a single point
+    std::vector<Eigen::Vector3i> number_of_points(clusters.size());
+    for (auto i = 0; i < static_cast<int>(clusters.size()); ++i)
+      for (auto k = 0; k < 3; ++k)
+        number_of_points[i](k) =
+            clusters[i].bbox_max_(k) > clusters[i].bbox_min_(k) ? n : 1;
+
+    // split the element tree into far and near field of the point clusters
+    std::vector<std::vector<const ElementTreeNode *>> far(clusters.size());
+    std::vector<std::vector<const ElementTreeNode *>> near(clusters.size());
+    std::vector<std::pair<int, const ElementTreeNode *>> stack;
+    stack.push_back(std::make_pair(0, std::addressof(element_tree.root())));
+    while (stack.size()) {
+      const PointCluster &cluster = clusters[stack.back().first];
+      const int id = stack.back().first;
+      const ElementTreeNode *element = stack.back().second;
+      stack.pop_back();
+      double dist = (cluster.midpoint_ - element->midpoint_).norm() -
+                    cluster.radius_ - element->radius_;
+      if (dist > 0 && cluster.radius_ < eta_ * dist &&
+          cluster.size() > number_of_points[id].prod()) {
+        far[id].push_back(element);
+      } else if (cluster.size() <= number_of_points[id].prod() ||
+                 (cluster.sons_.size() == 0 && element->sons_.size() == 0)) {
+        near[id].push_back(element);
+      } else if (element->sons_.size() &&
+                 (element->radius_ >= cluster.radius_ ||
+                  cluster.sons_.size() == 0)) {
+        for (auto &son : element->sons_)
+          stack.push_back(std::make_pair(id, std::addressof(son)));
+      } else {
+        for (auto son : cluster.sons_)
+          stack.push_back(std::make_pair(son, element));
+      }
+    }
+
+    // evaluate the far field in the interpolation points of the clusters
+    H2Multipole::ChebychevRoots roots(n);
+    Eigen::MatrixXd L =
+        H2Multipole::computeLagrangePolynomials<H2Multipole::ChebychevRoots>(n);
+    std::vector<int> far_clusters;
+    for (auto i = 0; i < static_cast<int>(clusters.size()); ++i)
+      if (far[i].size()) far_clusters.push_back(i);
+    std::vector<PotentialMatrix> far_values(clusters.size());
+#pragma omp parallel for schedule(dynamic)
+    for (auto k = 0; k < static_cast<int>(far_clusters.size()); ++k) {
+      const int id = far_clusters[k];
+      const PointCluster &cluster = clusters[id];
+      const Eigen::Vector3i &np = number_of_points[id];
+      PotentialMatrix &values = far_values[id];
+      values.resize(np.prod(), PotentialTraits<Derived>::OutputSpaceDimension);
+      values.setZero();
+      for (auto i = 0; i < values.rows(); ++i) {
+        Eigen::Vector3d node = clusters[id].midpoint_;
+        Eigen::Vector3i multi_index(i % np(0), (i / np(0)) % np(1),
+                                    i / (np(0) * np(1)));
+        for (auto d = 0; d < 3; ++d)
+          if (np(d) > 1)
+            node(d) = cluster.bbox_min_(d) +
+                      roots.points_(multi_index(d)) *
+                          (cluster.bbox_max_(d) - cluster.bbox_min_(d));
+        for (auto element_cluster : far[id])
+          for (const auto &element : *element_cluster)
+            for (const auto &qp : qps[deg_][element.id_])
+              values.row(i) +=
+                  pot_.evaluateIntegrand_impl(fun_ev_, element, node, qp);
+      }
+    }
+
+    // interpolate the far field and integrate the near field, every leaf of
+    // the point cluster tree writes to its own points only
+    std::vector<int> leaves;
+    for (auto i = 0; i < static_cast<int>(clusters.size()); ++i)
+      if (clusters[i].sons_.size() == 0) leaves.push_back(i);
+    PotentialMatrix potential;
+    potential.resize(points.rows(),
+                     PotentialTraits<Derived>::OutputSpaceDimension);
+    potential.setZero();
+#pragma omp parallel for schedule(dynamic)
+    for (auto k = 0; k < static_cast<int>(leaves.size()); ++k) {
+      // values of the Lagrange polynomials in every direction
+      Eigen::Matrix<double, Eigen::Dynamic, 3> lagrange(n, 3);
+      for (auto l = clusters[leaves[k]].begin_; l < clusters[leaves[k]].end_;
+           ++l) {
+        const int index = indices[l];
+        const Eigen::Vector3d point = points.row(index).transpose();
+        for (auto id = leaves[k]; id >= 0; id = clusters[id].parent_) {
+          const PointCluster &cluster = clusters[id];
+          if (far_values[id].size()) {
+            const Eigen::Vector3i &np = number_of_points[id];
+            for (auto d = 0; d < 3; ++d) {
+              if (np(d) == 1) {
+                lagrange(0, d) = 1;
+                continue;
+              }
+              double xi = (point(d) - cluster.bbox_min_(d)) /
+                          (cluster.bbox_max_(d) - cluster.bbox_min_(d));
+              for (auto j = 0; j < n; ++j) {
+                lagrange(j, d) = L(n - 1, j);
+                for (auto m = n - 2; m >= 0; --m)
+                  lagrange(j, d) =
+                      lagrange(j, d) * (xi - roots.points_(m)) + L(m, j);
+              }
             }
+            for (auto i = 0; i < far_values[id].rows(); ++i)
+              potential.row(index) +=
+                  lagrange(i % np(0), 0) * lagrange((i / np(0)) % np(1), 1) *
+                  lagrange(i / (np(0) * np(1)), 2) * far_values[id].row(i);
           }
+          for (auto element_cluster : near[id])
+            for (const auto &element : *element_cluster)
+              potential.row(index) +=
+                  integrateElement(GS, qps, element, point);
         }
       }
-#pragma omp critical
-      potential += my_potential;
     }
     return potential;
   }
+  /**
+   * \brief Evaluates the potential for every column of the densities set by
+   * set_multiple_cauchy_data().
+   *
+   * The integrand of a potential depends on the density only through its
+   * value, and its divergence for div-conforming spaces, in the quadrature
+   * point. In every quadrature point, these values are expressed for all
+   * densities in terms of the values of a few local basis functions. The
+   * integrand is then evaluated only for these basis functions and contracted
+   * with all densities at once by a small matrix product.
+   *
+   * The far-field interpolation and the adaptive quadrature are not combined
+   * with this contraction. If one of them is enabled, the densities are
+   * evaluated one after another by evaluate(), such that both methods always
+   * yield the same result.
+   */
+  std::vector<Eigen::Matrix<
+      typename PotentialReturnScalar<
+          typename LinearOperatorTraits<LinOp>::Scalar,
+          typename PotentialTraits<Derived>::Scalar>::Scalar,
+      Eigen::Dynamic, PotentialTraits<Derived>::OutputSpaceDimension>>
+  evaluateMultiple(const Eigen::Matrix<double, Eigen::Dynamic, 3> &points) {
+    typedef typename LinearOperatorTraits<LinOp>::Scalar Scalar;
+    typedef typename PotentialReturnScalar<
+        Scalar, typename PotentialTraits<Derived>::Scalar>::Scalar
+        PotentialScalar;
+    typedef Eigen::Matrix<PotentialScalar, Eigen::Dynamic,
+                          PotentialTraits<Derived>::OutputSpaceDimension>
+        PotentialMatrix;
+    constexpr int vector_dimension =
+        getFunctionSpaceVectorDimension<LinearOperatorTraits<LinOp>::Form>();
+    const int output_dimension = PotentialTraits<Derived>::OutputSpaceDimension;
+    const int number_of_densities = cauchy_data_.cols();
+
+    if (number_of_interpolation_points_ > 0 || quadrature_tolerance_ > 0) {
+      std::vector<PotentialMatrix> potentials(number_of_densities);
+      const FunctionEvaluator<LinOp> fun_ev = fun_ev_;
+      for (auto k = 0; k < number_of_densities; ++k) {
+        fun_ev_.set_function(cauchy_data_.col(k));
+        potentials[k] = evaluate(points);
+      }
+      fun_ev_ = fun_ev;
+      return potentials;
+    }
+
+    const SuperSpace<LinOp> &super_space = ansatz_space_.get_superspace();
+    const ElementTree &element_tree = super_space.get_mesh().get_element_tree();
+    std::vector<const ElementTreeNode *> elements;
+    for (auto element = element_tree.cpbegin();
+         element != element_tree.cpend(); ++element)
+      elements.push_back(std::addressof(*element));
+    const int polynomial_degree_plus_one_squared =
+        (super_space.get_polynomial_degree() + 1) *
+        (super_space.get_polynomial_degree() + 1);
+    const int local_size =
+        polynomial_degree_plus_one_squared * vector_dimension;
+
+    // quadrature points of all elements, indexed by the element id
+    const GaussSquare<Constants::maximum_quadrature_degree> &GS =
+        getGaussSquare<Constants::maximum_quadrature_degree>();
+    std::vector<ElementSurfacePoints> qps = computeQuadraturePoints(GS, deg_);
+
+    // coefficients of the densities with respect to the superspace
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> long_data =
+        ansatz_space_.get_transformation_matrix() * cauchy_data_;
+    const int number_of_rows = long_data.rows() / vector_dimension;
+
+    // function evaluators of the local basis functions, which only hold the
+    // coefficients of a single element and are shared by all elements
+    std::vector<FunctionEvaluator<LinOp>> basis_ev(local_size);
+    const FunctionEvaluator<LinOp> local_ev(ansatz_space_);
+    for (auto b = 0; b < local_size; ++b) {
+      Eigen::Matrix<Scalar, Eigen::Dynamic, vector_dimension> fun(
+          polynomial_degree_plus_one_squared, vector_dimension);
+      fun.setZero();
+      fun(b % polynomial_degree_plus_one_squared,
+          b / polynomial_degree_plus_one_squared) = 1;
+      basis_ev[b] = local_ev;
+      basis_ev[b].set_local_function(fun);
+    }
+
+    // per element: the basis functions and quadrature points the integrand is
+    // evaluated for and the coefficients of the densities with respect to them
+    std::vector<std::vector<int>> probe_basis(elements.size());
+    std::vector<std::vector<int>> probe_qp(elements.size());
+    std::vector<Eigen::Matrix<PotentialScalar, Eigen::Dynamic, Eigen::Dynamic>>
+        probe_coefficients(elements.size());
+#pragma omp parallel for schedule(dynamic)
+    for (auto e = 0; e < static_cast<int>(elements.size()); ++e) {
+      const ElementTreeNode &element = *elements[e];
+      Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> local_data(
+          local_size, number_of_densities);
+      for (auto b = 0; b < local_size; ++b)
+        local_data.row(b) = long_data.row(
+            (b / polynomial_degree_plus_one_squared) * number_of_rows +
+            polynomial_degree_plus_one_squared * element.id_ +
+            b % polynomial_degree_plus_one_squared);
+      std::vector<Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>>
+          coefficients;
+      for (auto q = 0; q < static_cast<int>(qps[element.id_].size()); ++q) {
+        const SurfacePoint &qp = qps[element.id_][q];
+        Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> values;
+        for (auto b = 0; b < local_size; ++b) {
+          auto value = evaluateDensity(basis_ev[b], element, qp);
+          values.resize(value.size(), local_size);
+          values.col(b) = value;
+        }
+        // select linearly independent basis functions
+        Eigen::ColPivHouseholderQR<
+            Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>>
+            qr(values);
+        Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> selected(
+            values.rows(), qr.rank());
+        for (auto j = 0; j < qr.rank(); ++j) {
+          const int b = qr.colsPermutation().indices()(j);
+          selected.col(j) = values.col(b);
+          probe_basis[e].push_back(b);
+          probe_qp[e].push_back(q);
+        }
+        coefficients.push_back(
+            selected.colPivHouseholderQr().solve(values * local_data));
+      }
+      probe_coefficients[e].resize(probe_basis[e].size(), number_of_densities);
+      for (auto q = 0, row = 0; q < static_cast<int>(coefficients.size());
+           row += coefficients[q].rows(), ++q)
+        probe_coefficients[e].middleRows(row, coefficients[q].rows()) =
+            coefficients[q].template cast<PotentialScalar>();
+    }
+
+    std::vector<PotentialMatrix> potentials(number_of_densities);
+    for (auto &potential : potentials) {
+      potential.resize(points.rows(), output_dimension);
+      potential.setZero();
+    }
+    // every thread owns tiles of points and writes to them only
+    const int number_of_tiles =
+        (points.rows() + Constants::potential_tile_size - 1) /
+        Constants::potential_tile_size;
+#pragma omp parallel for schedule(dynamic)
+    for (auto tile = 0; tile < number_of_tiles; ++tile) {
+      const int begin = tile * Constants::potential_tile_size;
+      const int end = std::min(begin + Constants::potential_tile_size,
+                               static_cast<int>(points.rows()));
+      Eigen::Matrix<PotentialScalar, Eigen::Dynamic, Eigen::Dynamic> integrands;
+      Eigen::Matrix<PotentialScalar, Eigen::Dynamic, Eigen::Dynamic> values;
+      for (auto e = 0; e < static_cast<int>(elements.size()); ++e) {
+        const ElementTreeNode &element = *elements[e];
+        integrands.resize(output_dimension, probe_basis[e].size());
+        for (auto i = begin; i < end; ++i) {
+          for (auto j = 0; j < static_cast<int>(probe_basis[e].size()); ++j)
+            integrands.col(j) = pot_.evaluateIntegrand_impl(
+                basis_ev[probe_basis[e][j]], element, points.row(i),
+                qps[element.id_][probe_qp[e][j]]);
+          values.noalias() = integrands * probe_coefficients[e];
+          for (auto k = 0; k < number_of_densities; ++k)
+            potentials[k].row(i) += values.col(k).transpose();
+        }
+      }
+    }
+    return potentials;
+  }
   //////////////////////////////////////////////////////////////////////////////
   //    setter
   //////////////////////////////////////////////////////////////////////////////
@@ -113,19 +421,243 @@ class DiscretePotential {
                           Eigen::Dynamic, 1> &cauchy_data) {
     fun_ev_.set_function(cauchy_data);
   }
+  /**
+   * \brief Sets several densities at once, one per column, which are
+   * evaluated by evaluateMultiple().
+   */
+  void set_multiple_cauchy_data(
+      const Eigen::Matrix<typename LinearOperatorTraits<LinOp>::Scalar,
+                          Eigen::Dynamic, Eigen::Dynamic> &cauchy_data) {
+    cauchy_data_ = cauchy_data;
+  }
   void set_degree(const int &deg) { deg_ = deg; }
+  /**
+   * \brief Sets the number of interpolation points per direction for the
+   * evaluation of the far field, see evaluateInterpolated(). For 0, which is
+   * the default, the potential is integrated directly in every point.
+   */
+  void set_number_of_interpolation_points(int number_of_points) {
+    number_of_interpolation_points_ = number_of_points;
+  }
+  /**
+   * \brief Sets the admissibility constant of the far field, see
+   * evaluateInterpolated().
+   */
+  void set_eta(double eta) { eta_ = eta; }
+  /**
+   * \brief Sets the relative accuracy of an adaptive quadrature. For a
+   * positive tolerance, the quadrature degree is chosen for every pair of
+   * element and evaluation point from the ratio of their distance and the
+   * radius of the element, and elements close to the point are subdivided.
+   * For 0, which is the default, every element is integrated by the degree
+   * set by set_degree().
+   */
+  void set_quadrature_tolerance(double tolerance) {
+    quadrature_tolerance_ = tolerance;
+  }
   //////////////////////////////////////////////////////////////////////////////
   //    getter
   //////////////////////////////////////////////////////////////////////////////
   Derived &get_potential() { return pot_; }
+  int get_number_of_interpolation_points() const {
+    return number_of_interpolation_points_;
+  }
+  double get_eta() const { return eta_; }
+  double get_quadrature_tolerance() const { return quadrature_tolerance_; }
   //////////////////////////////////////////////////////////////////////////////
-  //    private member variables
+  //    private methods
   //////////////////////////////////////////////////////////////////////////////
  private:
+  /**
+   * \brief Maps the quadrature points of GS[degree] on all elements to the
+   * surface. The result is indexed by the element id.
+   */
+  std::vector<ElementSurfacePoints> computeQuadraturePoints(
+      const GaussSquare<Constants::maximum_quadrature_degree> &GS,
+      int degree) const {
+    const Cubature &Q = GS[degree];
+    const SuperSpace<LinOp> &super_space = ansatz_space_.get_superspace();
+    const ElementTree &element_tree = super_space.get_mesh().get_element_tree();
+    auto surface_points = super_space.get_mesh().get_quadrature_points(Q);
+    std::vector<ElementSurfacePoints> qps(
+        element_tree.get_number_of_elements());
+    for (auto element = element_tree.cpbegin();
+         element != element_tree.cpend(); ++element) {
+      const ElementSurfacePoints &cached = (*surface_points)[element->id_];
+      ElementSurfacePoints &element_qps = qps[element->id_];
+      element_qps.assign(cached.begin(), cached.end());
+      // the cached weights are scaled by the mesh width only once
+      for (auto &qp : element_qps) qp(2) *= element->get_h();
+    }
+    return qps;
+  }
+  /**
+   * \brief Maps the quadrature points of all quadrature degrees to the
+   * surface which are used on entire elements, i.e., deg_ and, for adaptive
+   * quadrature, all degrees up to the one at the subdivision ratio. The
+   * result is indexed by the degree and the element id.
+   */
+  std::vector<std::vector<ElementSurfacePoints>> computeQuadratureRules(
+      const GaussSquare<Constants::maximum_quadrature_degree> &GS) const {
+    std::vector<std::vector<ElementSurfacePoints>> qps(
+        Constants::maximum_quadrature_degree + 1);
+    qps[deg_] = computeQuadraturePoints(GS, deg_);
+    if (quadrature_tolerance_ > 0)
+      for (auto degree = computeQuadratureDegree(
+               std::numeric_limits<double>::infinity());
+           degree <=
+           computeQuadratureDegree(Constants::potential_subdivision_ratio);
+           ++degree)
+        if (qps[degree].size() == 0)
+          qps[degree] = computeQuadraturePoints(GS, degree);
+    return qps;
+  }
+  /**
+   * \brief Returns the quadrature degree for an element whose radius is ratio
+   * times smaller than its distance to the evaluation point.
+   *
+   * The integrand is analytic in an ellipse around the element with foci at
+   * its boundary and semi-axes sum ratio + sqrt(ratio^2 - 1) in units of the
+   * radius, such that Gaussian quadrature converges at the square of this
+   * rate. The minimal degree integrates the polynomials of the ansatz space.
+   */
+  int computeQuadratureDegree(double ratio) const {
+    const int minimal_degree = ansatz_space_.get_polynomial_degree() / 2;
+    if (ratio == std::numeric_limits<double>::infinity()) return minimal_degree;
+    ratio = std::max(ratio, Constants::potential_minimal_ratio);
+    const double rate = std::log(ratio + std::sqrt(ratio * ratio - 1.));
+    const int degree =
+        minimal_degree +
+        static_cast<int>(std::ceil(-std::log(quadrature_tolerance_) /
+                                   (2. * rate)));
+    return std::min(degree, Constants::maximum_quadrature_degree);
+  }
+  /**
+   * \brief Integrates the potential of an element in a point. For adaptive
+   * quadrature, see set_quadrature_tolerance(), the degree is chosen by the
+   * ratio of the distance of the point to the element and its radius and
+   * close elements are subdivided.
+   */
+  Eigen::Matrix<typename PotentialReturnScalar<
+                    typename LinearOperatorTraits<LinOp>::Scalar,
+                    typename PotentialTraits<Derived>::Scalar>::Scalar,
+                PotentialTraits<Derived>::OutputSpaceDimension, 1>
+  integrateElement(
+      const GaussSquare<Constants::maximum_quadrature_degree> &GS,
+      const std::vector<std::vector<ElementSurfacePoints>> &qps,
+      const ElementTreeNode &element, const Eigen::Vector3d &point) const {
+    Eigen::Matrix<typename PotentialReturnScalar<
+                      typename LinearOperatorTraits<LinOp>::Scalar,
+                      typename PotentialTraits<Derived>::Scalar>::Scalar,
+                  PotentialTraits<Derived>::OutputSpaceDimension, 1>
+        retval;
+    retval.setZero();
+    if (quadrature_tolerance_ <= 0) {
+      for (const auto &qp : qps[deg_][element.id_])
+        retval += pot_.evaluateIntegrand_impl(fun_ev_, element, point, qp);
+      return retval;
+    }
+    const double ratio = (point - element.midpoint_).norm() / element.radius_;
+    if (ratio >= Constants::potential_subdivision_ratio) {
+      for (const auto &qp : qps[computeQuadratureDegree(ratio)][element.id_])
+        retval += pot_.evaluateIntegrand_impl(fun_ev_, element, point, qp);
+      return retval;
+    }
+    return integrateSubdivided(GS, element, point, Eigen::Vector2d(0., 0.),
+                               1., element.radius_, 0);
+  }
+  /**
+   * \brief Integrates the potential of the square with lower left corner llc
+   * and side length h in the reference domain of an element in a point.
+   * Squares whose enclosing radius is not sufficiently small compared to the
+   * distance to the point are subdivided recursively.
+   */
+  Eigen::Matrix<typename PotentialReturnScalar<
+                    typename LinearOperatorTraits<LinOp>::Scalar,
+                    typename PotentialTraits<Derived>::Scalar>::Scalar,
+                PotentialTraits<Derived>::OutputSpaceDimension, 1>
+  integrateSubdivided(
+      const GaussSquare<Constants::maximum_quadrature_degree> &GS,
+      const ElementTreeNode &element, const Eigen::Vector3d &point,
+      const Eigen::Vector2d &llc, double h, double radius, int level) const {
+    Eigen::Matrix<typename PotentialReturnScalar<
+                      typename LinearOperatorTraits<LinOp>::Scalar,
+                      typename PotentialTraits<Derived>::Scalar>::Scalar,
+                  PotentialTraits<Derived>::OutputSpaceDimension, 1>
+        retval;
+    retval.setZero();
+    const SuperSpace<LinOp> &super_space = ansatz_space_.get_superspace();
+    SurfacePoint qp;
+    super_space.map2surface(element, llc + Eigen::Vector2d(.5 * h, .5 * h), 1.,
+                            &qp);
+    const double ratio = (point - qp.segment<3>(3)).norm() / radius;
+    if (ratio < Constants::potential_subdivision_ratio &&
+        level < Constants::potential_maximum_subdivision_level) {
+      for (auto i = 0; i < 4; ++i)
+        retval += integrateSubdivided(
+            GS, element, point,
+            llc + h * Eigen::Vector2d(Constants::llcs[0][i],
+                                      Constants::llcs[1][i]),
+            .5 * h, .5 * radius, level + 1);
+      return retval;
+    }
+    const Cubature &Q = GS[computeQuadratureDegree(ratio)];
+    const double weight_scaling = element.get_h() * element.get_h() * h * h;
+    for (auto j = 0; j < Q.w_.size(); ++j) {
+      super_space.map2surface(element, llc + h * Q.xi_.col(j),
+                              weight_scaling * Q.w_(j), &qp);
+      retval += pot_.evaluateIntegrand_impl(fun_ev_, element, point, qp);
+    }
+    return retval;
+  }
+  /**
+   * \brief Returns the values of a function in a surface point the integrand
+   * of the potential depends on, i.e., the value and for div-conforming spaces
+   * also the divergence.
+   */
+  Eigen::Matrix<typename LinearOperatorTraits<LinOp>::Scalar, Eigen::Dynamic,
+                1>
+  evaluateDensity(const FunctionEvaluator<LinOp> &fun_ev,
+                  const ElementTreeNode &element,
+                  const SurfacePoint &p) const {
+    return evaluateDensity(
+        fun_ev, element, p,
+        std::integral_constant<
+            bool, static_cast<int>(LinearOperatorTraits<LinOp>::Form) ==
+                      DifferentialForm::DivConforming>());
+  }
+  Eigen::Matrix<typename LinearOperatorTraits<LinOp>::Scalar, Eigen::Dynamic,
+                1>
+  evaluateDensity(const FunctionEvaluator<LinOp> &fun_ev,
+                  const ElementTreeNode &element, const SurfacePoint &p,
+                  std::false_type) const {
+    return fun_ev.evaluate(element, p);
+  }
+  Eigen::Matrix<typename LinearOperatorTraits<LinOp>::Scalar, Eigen::Dynamic,
+                1>
+  evaluateDensity(const FunctionEvaluator<LinOp> &fun_ev,
+                  const ElementTreeNode &element, const SurfacePoint &p,
+                  std::true_type) const {
+    auto value = fun_ev.evaluate(element, p);
+    Eigen::Matrix<typename LinearOperatorTraits<LinOp>::Scalar, Eigen::Dynamic,
+                  1>
+        retval(value.size() + 1);
+    retval << value, fun_ev.evaluateDiv(element, p);
+    return retval;
+  }
+  //////////////////////////////////////////////////////////////////////////////
+  //    private member variables
+  //////////////////////////////////////////////////////////////////////////////
   int deg_;
+  int number_of_interpolation_points_;
+  double eta_;
+  double quadrature_tolerance_;
   Derived pot_;
   AnsatzSpace<LinOp> ansatz_space_;
   FunctionEvaluator<LinOp> fun_ev_;
+  Eigen::Matrix<typename LinearOperatorTraits<LinOp>::Scalar, Eigen::Dynamic,
+                Eigen::Dynamic>
+      cauchy_data_;
 };  // namespace Bembel
 
 }  // namespace Bembel
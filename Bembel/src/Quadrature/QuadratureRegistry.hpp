@@ -0,0 +1,39 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+#ifndef BEMBEL_SRC_QUADRATURE_QUADRATUREREGISTRY_HPP_
+#define BEMBEL_SRC_QUADRATURE_QUADRATUREREGISTRY_HPP_
+
+namespace Bembel {
+/**
+ *  \ingroup Quadrature
+ *  \brief Returns the Gauss-Legendre rules on [0,1] up to the given order.
+ *
+ *  The rules are computed on the first call and shared by all subsequent
+ *  calls in the process. The initialization is thread-safe, since static
+ *  local variables are initialized exactly once.
+ **/
+template <unsigned int Order>
+inline const GaussLegendre<Order> &getGaussLegendre() {
+  static const GaussLegendre<Order> GL;
+  return GL;
+}
+/**
+ *  \ingroup Quadrature
+ *  \brief Returns the tensor product Gauss-Legendre rules on [0,1]^2 up to
+ *  the given order, see getGaussLegendre.
+ **/
+template <unsigned int Order>
+inline const GaussSquare<Order> &getGaussSquare() {
+  static const GaussSquare<Order> GS;
+  return GS;
+}
+}  // namespace Bembel
+#endif  // BEMBEL_SRC_QUADRATURE_QUADRATUREREGISTRY_HPP_
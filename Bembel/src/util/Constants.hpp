@@ -35,6 +35,15 @@ constexpr size_t Bembel_alloc_size = 100;
 // to filter some almost-zero coefficients that might be introduced during the
 // solution of the linear system
 constexpr double projector_tolerance = 1e-4;
+// number of evaluation points a thread handles at once in the evaluation of
+// potentials
+constexpr int potential_tile_size = 64;
+// the adaptive quadrature of potentials subdivides elements whose radius is
+// not this ratio smaller than the distance to the evaluation point, up to the
+// given level, and treats ratios below the minimal ratio as the latter
+constexpr double potential_subdivision_ratio = 1.5;
+constexpr int potential_maximum_subdivision_level = 10;
+constexpr double potential_minimal_ratio = 1.05;
 ////////////////////////////////////////////////////////////////////////////////
 /// physical constants
 ////////////////////////////////////////////////////////////////////////////////
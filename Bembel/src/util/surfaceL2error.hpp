@@ -22,8 +22,8 @@ double surfaceL2error(const AnsatzSpace<Op> &ansatz_space,
   FunctionEvaluator<Op> fun_val(ansatz_space);
   fun_val.set_function(vec);
   Scalar retval = 0;
-  GaussSquare<Constants::maximum_quadrature_degree> GS;
-  auto Q = GS[deg];
+  const Cubature &Q =
+      getGaussSquare<Constants::maximum_quadrature_degree>()[deg];
   SurfacePoint qp;
   const auto &super_space = ansatz_space.get_superspace();
   const ElementTree &et = super_space.get_mesh().get_element_tree();
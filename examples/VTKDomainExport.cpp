@@ -22,20 +22,22 @@ int main() {
   // Now we can add user defined data. There are different options.
   // Exceptionally handy is a dataset that describes the distance to the
   // geometry. This is useful for paraview visualizations, s.t. one can use the
-  // threashold feature to clip the domain. For this, we can just iterate over
-  // the elements of a ClusterTree. Usually the ClusterTree is hidden in an
-  // ansatz space and can be accest via the get_mesh() method. Try running the
-  // example_VTKSurfaceExport and visualise both files on top of each other.
+  // threashold feature to clip the domain. For this, we can set up an
+  // ElementBVH over the elements of a ClusterTree. Usually the ClusterTree is
+  // hidden in an ansatz space and can be accest via the get_mesh() method. Try
+  // running the example_VTKSurfaceExport and visualise both files on top of
+  // each other.
   ClusterTree mesh(geo, 5);
+  ElementBVH bvh(mesh);
   std::function<double(const Eigen::Vector3d&)> fun1 =
       [&](const Eigen::Vector3d& point_in_space) {
-        double dist = 1000;
-        for (auto e = mesh.get_element_tree().cpbegin();
-             e != mesh.get_element_tree().cpend(); ++e) {
-          double new_dist = ((*e).midpoint_ - point_in_space).norm();
-          dist = dist > new_dist ? new_dist : dist;
-        }
-        return dist;
+        return bvh.computeDistance(point_in_space);
+      };
+
+  // The ElementBVH also tells whether a point lies inside the geometry.
+  std::function<double(const Eigen::Vector3d&)> fun3 =
+      [&](const Eigen::Vector3d& point_in_space) {
+        return double(bvh.isInside(point_in_space));
       };
 
   // One can also visualize vector fields.
@@ -49,6 +51,7 @@ int main() {
 
   writer.addDataSet("Distance_to_sphere", fun1);
   writer.addDataSet("Some_vector_field", fun2);
+  writer.addDataSet("Inside_sphere", fun3);
 
   // Finally, we print to file.
   writer.writeToFile("example.vts");
@@ -0,0 +1,82 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks that the adaptive near-field quadrature chooses a
+ * degree per class of element pairs, such that the system matrix meets the
+ * requested tolerance and is more accurate than with the heuristic degrees.
+ */
+
+#include <Bembel/AnsatzSpace>
+#include <Bembel/Geometry>
+#include <Bembel/Laplace>
+#include <Bembel/LinearForm>
+
+#include "tests/Test.hpp"
+
+int main() {
+  using namespace Bembel;
+
+  int polynomial_degree = 1;
+  int refinement_level = 1;
+
+  Geometry geometry("sphere.dat");
+  AnsatzSpace<LaplaceSingleLayerOperator> ansatz_space(
+      geometry, refinement_level, polynomial_degree);
+
+  // reference with a tight tolerance
+  DiscreteOperator<Eigen::MatrixXd, LaplaceSingleLayerOperator> reference_op(
+      ansatz_space);
+  reference_op.get_linear_operator().set_nearfield_quadrature_tolerance(1e-12);
+  reference_op.compute();
+  const Eigen::MatrixXd &reference = reference_op.get_discrete_operator();
+  // identical, edge, vertex and at least one distance class
+  BEMBEL_TEST_IF(reference_op.get_linear_operator()
+                     .get_nearfield_quadrature_degrees()
+                     .get_number_of_classes() > 3);
+
+  // the heuristic degrees
+  DiscreteOperator<Eigen::MatrixXd, LaplaceSingleLayerOperator> disc_op(
+      ansatz_space);
+  disc_op.compute();
+  const double heuristic_error =
+      (disc_op.get_discrete_operator() - reference).norm() / reference.norm();
+
+  for (double tolerance : {1e-4, 1e-6, 1e-8}) {
+    DiscreteOperator<Eigen::MatrixXd, LaplaceSingleLayerOperator> adaptive_op(
+        ansatz_space);
+    adaptive_op.get_linear_operator().set_nearfield_quadrature_tolerance(
+        tolerance);
+    adaptive_op.compute();
+    const double error =
+        (adaptive_op.get_discrete_operator() - reference).norm() /
+        reference.norm();
+    BEMBEL_TEST_IF(error < 10 * tolerance);
+    BEMBEL_TEST_IF(error < heuristic_error);
+  }
+
+  // the degrees are fixed before the assembly, such that repeated assemblies
+  // coincide independently of the scheduling of the element pairs
+  {
+    DiscreteOperator<Eigen::MatrixXd, LaplaceSingleLayerOperator> first_op(
+        ansatz_space);
+    first_op.get_linear_operator().set_nearfield_quadrature_tolerance(1e-6);
+    first_op.compute();
+    DiscreteOperator<Eigen::MatrixXd, LaplaceSingleLayerOperator> second_op(
+        ansatz_space);
+    second_op.get_linear_operator().set_nearfield_quadrature_tolerance(1e-6);
+    second_op.compute();
+    BEMBEL_TEST_IF(first_op.get_discrete_operator() ==
+                   second_op.get_discrete_operator());
+  }
+
+  return 0;
+}
@@ -0,0 +1,62 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks that copies of an AnsatzSpace share the mesh and the
+ * transformation matrix, whereas a clone owns an equal transformation matrix.
+ */
+
+#include <Bembel/AnsatzSpace>
+#include <Bembel/Geometry>
+#include <Bembel/H2Matrix>
+#include <Bembel/Laplace>
+
+#include "tests/Test.hpp"
+
+int main() {
+  using namespace Bembel;
+
+  int polynomial_degree = 2;
+  int refinement_level = 2;
+
+  Geometry geometry("sphere.dat");
+  AnsatzSpace<LaplaceSingleLayerOperator> ansatz_space(
+      geometry, refinement_level, polynomial_degree);
+
+  AnsatzSpace<LaplaceSingleLayerOperator> copy = ansatz_space;
+  BEMBEL_TEST_IF(&copy.get_transformation_matrix() ==
+                 &ansatz_space.get_transformation_matrix());
+  BEMBEL_TEST_IF(&copy.get_superspace().get_mesh() ==
+                 &ansatz_space.get_superspace().get_mesh());
+
+  AnsatzSpace<LaplaceSingleLayerOperator> clone = ansatz_space.clone();
+  BEMBEL_TEST_IF(&clone.get_transformation_matrix() !=
+                 &ansatz_space.get_transformation_matrix());
+  BEMBEL_TEST_IF(clone.get_number_of_dofs() ==
+                 ansatz_space.get_number_of_dofs());
+  BEMBEL_TEST_IF((Eigen::MatrixXd(clone.get_transformation_matrix()) -
+                  Eigen::MatrixXd(ansatz_space.get_transformation_matrix()))
+                     .norm() == 0);
+
+  // the H2-matrix keeps the transformation matrix of the ansatz space
+  LaplaceSingleLayerOperator linOp;
+  Eigen::H2Matrix<double> H;
+  H.init_H2Matrix(linOp, ansatz_space);
+  BEMBEL_TEST_IF(&H.get_transformation_matrix() ==
+                 &ansatz_space.get_transformation_matrix());
+  BEMBEL_TEST_IF(H.rows() == ansatz_space.get_number_of_dofs());
+
+  // a default constructed space has no degrees of freedom
+  AnsatzSpace<LaplaceSingleLayerOperator> empty;
+  BEMBEL_TEST_IF(empty.get_number_of_dofs() == 0);
+
+  return 0;
+}
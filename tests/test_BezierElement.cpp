@@ -0,0 +1,139 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks that the rational Bezier representation of the
+ * geometry on the elements coincides with the one of the patches, also if
+ * interior knots of a patch cut the elements.
+ */
+
+#include <Bembel/AnsatzSpace>
+#include <Bembel/Geometry>
+#include <Bembel/Laplace>
+
+#include "tests/Test.hpp"
+
+int main() {
+  using namespace Bembel;
+
+  int polynomial_degree = 1;
+  int refinement_level = 2;
+
+  Geometry geometry("sphere.dat");
+  AnsatzSpace<LaplaceSingleLayerOperator> ansatz_space(
+      geometry, refinement_level, polynomial_degree);
+  const SuperSpace<LaplaceSingleLayerOperator> &super_space =
+      ansatz_space.get_superspace();
+  const ClusterTree &mesh = super_space.get_mesh();
+  const ElementTree &element_tree = mesh.get_element_tree();
+
+  // reference values from the B-spline representation of the patches
+  std::vector<ElementSurfacePoints> reference(
+      element_tree.get_number_of_elements());
+  for (auto element = element_tree.cpbegin(); element != element_tree.cpend();
+       ++element)
+    for (auto x : Test::Constants::eq_points)
+      for (auto y : Test::Constants::eq_points) {
+        SurfacePoint srf_pt;
+        super_space.map2surface(*element, Eigen::Vector2d(x, y), 3.1415,
+                                &srf_pt);
+        reference[element->id_].push_back(srf_pt);
+      }
+
+  // the BezierElements are opted in when the ansatz space is set up
+  BEMBEL_TEST_IF(!mesh.has_bezier_elements());
+  AnsatzSpace<LaplaceSingleLayerOperator> bezier_space(
+      geometry, refinement_level, polynomial_degree, 1, true);
+  const SuperSpace<LaplaceSingleLayerOperator> &bezier_super_space =
+      bezier_space.get_superspace();
+  const ClusterTree &bezier_mesh = bezier_super_space.get_mesh();
+  const ElementTree &bezier_tree = bezier_mesh.get_element_tree();
+  BEMBEL_TEST_IF(bezier_mesh.has_bezier_elements());
+
+  // the cache is shared by copies of the ansatz space
+  AnsatzSpace<LaplaceSingleLayerOperator> copy = bezier_space;
+  BEMBEL_TEST_IF(copy.get_superspace().get_mesh().has_bezier_elements());
+
+  for (auto element = bezier_tree.cpbegin(); element != bezier_tree.cpend();
+       ++element) {
+    const BezierElement &bezier_element =
+        bezier_mesh.get_bezier_element(element->id_);
+    const Patch &patch = bezier_mesh.get_geometry()[element->patch_];
+    int k = 0;
+    for (auto x : Test::Constants::eq_points)
+      for (auto y : Test::Constants::eq_points) {
+        const Eigen::Vector2d xi(x, y);
+        SurfacePoint srf_pt;
+        bezier_super_space.map2surface(*element, xi, 3.1415, &srf_pt);
+        BEMBEL_TEST_IF((srf_pt - reference[element->id_][k++]).norm() <
+                       Test::Constants::test_tolerance_geometry);
+
+        const Eigen::Vector2d st = element->llc_ + element->get_h() * xi;
+        BEMBEL_TEST_IF((bezier_element.eval(xi) - patch.eval(st)).norm() <
+                       Test::Constants::test_tolerance_geometry);
+        BEMBEL_TEST_IF(
+            (bezier_element.evalJacobian(xi) - patch.evalJacobian(st)).norm() <
+            Test::Constants::test_tolerance_geometry);
+      }
+  }
+
+  // rational patch of degree two with non-dyadic interior knots, such that
+  // the elements of a uniform refinement are cut by the knots
+  {
+    std::vector<double> knots_x = {0, 0, 0, .3, .7, 1, 1, 1};
+    std::vector<double> knots_y = {0, 0, 0, .4, 1, 1, 1};
+    std::vector<Eigen::MatrixXd> xyzw(4, Eigen::MatrixXd(4, 5));
+    for (int i = 0; i < 4; ++i)
+      for (int j = 0; j < 5; ++j) {
+        xyzw[0](i, j) = j;
+        xyzw[1](i, j) = i;
+        xyzw[2](i, j) = std::sin(i + 2. * j);
+        xyzw[3](i, j) = 1. + .1 * ((i + j) % 3);
+      }
+    for (int k = 0; k < 3; ++k) xyzw[k] = xyzw[k].cwiseProduct(xyzw[3]);
+    Patch patch(xyzw, knots_x, knots_y);
+    const double h = .25;
+    int number_of_pieces = 0;
+    for (int ex = 0; ex < 4; ++ex)
+      for (int ey = 0; ey < 4; ++ey) {
+        const Eigen::Vector2d llc(ex * h, ey * h);
+        BezierElement bezier_element(patch, llc, h);
+        number_of_pieces += bezier_element.get_number_of_pieces();
+        for (auto x : Test::Constants::eq_points)
+          for (auto y : Test::Constants::eq_points) {
+            const Eigen::Vector2d xi(x, y);
+            const Eigen::Vector2d st = llc + h * xi;
+            BEMBEL_TEST_IF((bezier_element.eval(xi) - patch.eval(st)).norm() <
+                           Test::Constants::test_tolerance_geometry);
+            // Patch::evalJacobian presumes a single knot span, hence the
+            // Jacobian is compared to difference quotients
+            const Eigen::Matrix<double, 3, 2> jacobian =
+                bezier_element.evalJacobian(xi);
+            for (int d = 0; d < 2; ++d) {
+              Eigen::Vector2d st_minus = st;
+              Eigen::Vector2d st_plus = st;
+              st_minus(d) = std::max(st(d) - 1e-6, 0.);
+              st_plus(d) = std::min(st(d) + 1e-6, 1.);
+              const Eigen::Vector3d difference_quotient =
+                  (patch.eval(st_plus) - patch.eval(st_minus)) /
+                  (st_plus(d) - st_minus(d));
+              BEMBEL_TEST_IF((jacobian.col(d) - difference_quotient).norm() <
+                             1e-4);
+            }
+          }
+      }
+    // the knots .3 and .7 cut two columns and the knot .4 cuts one row of
+    // elements into two pieces each
+    BEMBEL_TEST_IF(number_of_pieces == (4 + 2) * (4 + 1));
+  }
+
+  return 0;
+}
@@ -0,0 +1,105 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks that the assembly of several right hand sides at once
+ * coincides with the assembly of one right hand side after another, and that
+ * both reproduce known surface integrals on the unit sphere.
+ */
+
+#include <Bembel/AnsatzSpace>
+#include <Bembel/Geometry>
+#include <Bembel/Laplace>
+#include <Bembel/LinearForm>
+#include <Bembel/Maxwell>
+
+#include "tests/Test.hpp"
+
+int main() {
+  using namespace Bembel;
+
+  int polynomial_degree = 1;
+  int refinement_level = 2;
+  int number_of_functions = 3;
+
+  Geometry geometry("sphere.dat");
+
+  // scalar functions
+  {
+    AnsatzSpace<LaplaceSingleLayerOperator> ansatz_space(
+        geometry, refinement_level, polynomial_degree);
+    std::vector<std::function<double(Eigen::Vector3d)>> functions;
+    for (auto k = 0; k < number_of_functions; ++k)
+      functions.push_back([k](Eigen::Vector3d x) {
+        return std::sin((k + 1) * x(0)) * x(1) + x(2);
+      });
+    DiscreteLinearForm<DirichletTrace<double>, LaplaceSingleLayerOperator>
+        disc_lf(ansatz_space);
+    Eigen::MatrixXd multiple = disc_lf.computeMultiple(functions);
+    BEMBEL_TEST_IF(multiple.cols() == number_of_functions);
+    for (auto k = 0; k < number_of_functions; ++k) {
+      disc_lf.get_linear_form().set_function(functions[k]);
+      disc_lf.compute();
+      BEMBEL_TEST_IF((multiple.col(k) - disc_lf.get_discrete_linear_form())
+                         .norm() < Constants::generic_tolerance);
+    }
+  }
+
+  // the shape functions are scaled by 1 / h and form a partition of unity
+  // otherwise, such that h times the sum of the entries of the load vector is
+  // the surface integral of the function, which is 4 pi / (2k + 1) for z^(2k)
+  // on the unit sphere
+  {
+    AnsatzSpace<LaplaceSingleLayerOperator> ansatz_space(
+        geometry, refinement_level, polynomial_degree);
+    std::vector<std::function<double(Eigen::Vector3d)>> functions;
+    for (auto k = 0; k < number_of_functions; ++k)
+      functions.push_back(
+          [k](Eigen::Vector3d x) { return std::pow(x(2), 2 * k); });
+    DiscreteLinearForm<DirichletTrace<double>, LaplaceSingleLayerOperator>
+        disc_lf(ansatz_space);
+    disc_lf.set_degree(10);
+    Eigen::MatrixXd multiple = disc_lf.computeMultiple(functions);
+    const double h = std::pow(2., -refinement_level);
+    for (auto k = 0; k < number_of_functions; ++k) {
+      const double integral = 4. * BEMBEL_PI / (2. * k + 1.);
+      BEMBEL_TEST_IF(std::abs(h * multiple.col(k).sum() - integral) < 1e-6);
+      disc_lf.get_linear_form().set_function(functions[k]);
+      disc_lf.compute();
+      BEMBEL_TEST_IF(std::abs(h * disc_lf.get_discrete_linear_form().sum() -
+                              integral) < 1e-6);
+    }
+  }
+
+  // vector valued functions
+  {
+    AnsatzSpace<MaxwellSingleLayerOperator> ansatz_space(
+        geometry, refinement_level, polynomial_degree);
+    std::vector<std::function<Eigen::Vector3cd(Eigen::Vector3d)>> functions;
+    for (auto k = 0; k < number_of_functions; ++k)
+      functions.push_back([k](Eigen::Vector3d x) {
+        return Eigen::Vector3cd(
+            std::exp(std::complex<double>(0., k + 1.) * x(2)), 0., x(0));
+      });
+    DiscreteLinearForm<RotatedTangentialTrace<std::complex<double>>,
+                       MaxwellSingleLayerOperator>
+        disc_lf(ansatz_space);
+    Eigen::MatrixXcd multiple = disc_lf.computeMultiple(functions);
+    for (auto k = 0; k < number_of_functions; ++k) {
+      disc_lf.get_linear_form().set_function(functions[k]);
+      disc_lf.compute();
+      BEMBEL_TEST_IF((multiple.col(k) - disc_lf.get_discrete_linear_form())
+                         .norm() < Constants::generic_tolerance);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,87 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks that the parallel assembly of local operators
+ * coincides with the assembly of the element matrices by triplets.
+ */
+
+#include <Bembel/Identity>
+#include <Bembel/LaplaceBeltrami>
+
+#include "tests/Test.hpp"
+
+template <typename Derived>
+Eigen::SparseMatrix<double> assembleByTriplets(
+    const Derived &lin_op, const Bembel::AnsatzSpace<Derived> &ansatz_space) {
+  using namespace Bembel;
+  const auto &super_space = ansatz_space.get_superspace();
+  const auto &element_tree = super_space.get_mesh().get_element_tree();
+  const int number_of_elements = element_tree.get_number_of_elements();
+  const int p2 = (super_space.get_polynomial_degree() + 1) *
+                 (super_space.get_polynomial_degree() + 1);
+  const Cubature &Q = getGaussSquare<Constants::maximum_quadrature_degree>()
+      [lin_op.get_FarfieldQuadratureDegree(
+          super_space.get_polynomial_degree())];
+  std::vector<Eigen::Triplet<double>> triplets;
+  for (auto element = element_tree.cpbegin(); element != element_tree.cpend();
+       ++element) {
+    Eigen::MatrixXd intval = Eigen::MatrixXd::Zero(p2, p2);
+    for (int i = 0; i < Q.w_.size(); ++i) {
+      SurfacePoint qp;
+      super_space.map2surface(*element, Q.xi_.col(i), Q.w_(i), &qp);
+      lin_op.evaluateIntegrand(super_space, qp, qp, &intval);
+    }
+    for (int i = 0; i < p2; ++i)
+      for (int j = 0; j < p2; ++j)
+        triplets.push_back(Eigen::Triplet<double>(
+            p2 * element->id_ + j, p2 * element->id_ + i, intval(j, i)));
+  }
+  Eigen::SparseMatrix<double> local_matrix(p2 * number_of_elements,
+                                           p2 * number_of_elements);
+  local_matrix.setFromTriplets(triplets.begin(), triplets.end());
+  const auto &projector = ansatz_space.get_transformation_matrix();
+  return projector.transpose() * (local_matrix * projector);
+}
+
+template <typename Derived>
+bool checkAssembly(const Bembel::Geometry &geometry, int refinement_level,
+                   int polynomial_degree) {
+  Bembel::AnsatzSpace<Derived> ansatz_space(geometry, refinement_level,
+                                            polynomial_degree);
+  Bembel::DiscreteLocalOperator<Derived> disc_op(ansatz_space);
+  disc_op.compute();
+  const Eigen::SparseMatrix<double> &matrix = disc_op.get_discrete_operator();
+  const Eigen::SparseMatrix<double> reference =
+      assembleByTriplets(disc_op.get_linear_operator(), ansatz_space);
+  if (matrix.rows() != ansatz_space.get_number_of_dofs() ||
+      matrix.cols() != ansatz_space.get_number_of_dofs())
+    return false;
+  return (matrix - reference).norm() <
+         Test::Constants::test_tolerance_geometry * reference.norm();
+}
+
+int main() {
+  using namespace Bembel;
+
+  Geometry geometry("sphere.dat");
+  for (int polynomial_degree = 0; polynomial_degree < 3; ++polynomial_degree)
+    for (int refinement_level = 0; refinement_level < 3; ++refinement_level) {
+      BEMBEL_TEST_IF(checkAssembly<MassMatrixScalarDisc>(
+          geometry, refinement_level, polynomial_degree));
+      BEMBEL_TEST_IF(checkAssembly<MassMatrixScalarCont>(
+          geometry, refinement_level, polynomial_degree + 1));
+      BEMBEL_TEST_IF(checkAssembly<LaplaceBeltramiOperator>(
+          geometry, refinement_level, polynomial_degree + 1));
+    }
+
+  return 0;
+}
@@ -0,0 +1,180 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks that the evaluation of a DiscretePotential with
+ * interpolated far field and the evaluation of several densities at once
+ * coincide with the direct evaluation. Moreover, it checks the accuracy of the
+ * adaptive quadrature close to the surface.
+ */
+
+#include <Bembel/AnsatzSpace>
+#include <Bembel/Geometry>
+#include <Bembel/Helmholtz>
+#include <Bembel/Laplace>
+#include <Bembel/Maxwell>
+
+#include "tests/Test.hpp"
+
+int main() {
+  using namespace Bembel;
+
+  int polynomial_degree = 1;
+  int refinement_level = 1;
+  int number_of_interpolation_points = 6;
+
+  Geometry geometry("sphere.dat");
+
+  // points on a grid which keep some distance to the unit sphere
+  Eigen::VectorXd grid = Eigen::VectorXd::LinSpaced(40, -3, 3);
+  std::vector<Eigen::Vector3d> grid_points;
+  for (auto i = 0; i < grid.size(); ++i)
+    for (auto j = 0; j < grid.size(); ++j)
+      for (auto k = 0; k < grid.size(); ++k) {
+        Eigen::Vector3d point(grid(i), grid(j), grid(k));
+        if (std::abs(point.norm() - 1.) > 0.1) grid_points.push_back(point);
+      }
+  Eigen::Matrix<double, Eigen::Dynamic, 3> points(grid_points.size(), 3);
+  for (auto i = 0; i < grid_points.size(); ++i)
+    points.row(i) = grid_points[i].transpose();
+
+  // Laplace
+  {
+    AnsatzSpace<LaplaceSingleLayerOperator> ansatz_space(
+        geometry, refinement_level, polynomial_degree);
+    DiscretePotential<LaplaceSingleLayerPotential<LaplaceSingleLayerOperator>,
+                      LaplaceSingleLayerOperator>
+        disc_pot(ansatz_space);
+    disc_pot.set_cauchy_data(
+        Eigen::VectorXd::Random(ansatz_space.get_number_of_dofs()));
+    Eigen::VectorXd direct = disc_pot.evaluate(points);
+    disc_pot.set_number_of_interpolation_points(
+        number_of_interpolation_points);
+    Eigen::VectorXd interpolated = disc_pot.evaluate(points);
+    BEMBEL_TEST_IF((direct - interpolated).norm() / direct.norm() < 1e-3);
+  }
+
+  // Helmholtz
+  {
+    std::complex<double> wavenumber(2., 0.);
+    AnsatzSpace<HelmholtzSingleLayerOperator> ansatz_space(
+        geometry, refinement_level, polynomial_degree);
+    DiscretePotential<
+        HelmholtzSingleLayerPotential<HelmholtzSingleLayerOperator>,
+        HelmholtzSingleLayerOperator>
+        disc_pot(ansatz_space);
+    disc_pot.get_potential().set_wavenumber(wavenumber);
+    disc_pot.set_cauchy_data(
+        Eigen::VectorXcd::Random(ansatz_space.get_number_of_dofs()));
+    Eigen::VectorXcd direct = disc_pot.evaluate(points);
+    disc_pot.set_number_of_interpolation_points(
+        number_of_interpolation_points);
+    Eigen::VectorXcd interpolated = disc_pot.evaluate(points);
+    BEMBEL_TEST_IF((direct - interpolated).norm() / direct.norm() < 1e-3);
+  }
+
+  // Maxwell
+  {
+    std::complex<double> wavenumber(2., 0.);
+    AnsatzSpace<MaxwellSingleLayerOperator> ansatz_space(
+        geometry, refinement_level, polynomial_degree);
+    DiscretePotential<MaxwellSingleLayerPotential<MaxwellSingleLayerOperator>,
+                      MaxwellSingleLayerOperator>
+        disc_pot(ansatz_space);
+    disc_pot.get_potential().set_wavenumber(wavenumber);
+    disc_pot.set_cauchy_data(
+        Eigen::VectorXcd::Random(ansatz_space.get_number_of_dofs()));
+    Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 3> direct =
+        disc_pot.evaluate(points);
+    disc_pot.set_number_of_interpolation_points(
+        number_of_interpolation_points);
+    Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 3> interpolated =
+        disc_pot.evaluate(points);
+    BEMBEL_TEST_IF((direct - interpolated).norm() / direct.norm() < 1e-3);
+  }
+
+  // several densities at once
+  {
+    int number_of_densities = 3;
+    AnsatzSpace<HelmholtzSingleLayerOperator> ansatz_space(
+        geometry, refinement_level, polynomial_degree);
+    DiscretePotential<
+        HelmholtzSingleLayerPotential<HelmholtzSingleLayerOperator>,
+        HelmholtzSingleLayerOperator>
+        disc_pot(ansatz_space);
+    disc_pot.get_potential().set_wavenumber(std::complex<double>(2., 0.));
+    Eigen::MatrixXcd densities = Eigen::MatrixXcd::Random(
+        ansatz_space.get_number_of_dofs(), number_of_densities);
+    disc_pot.set_multiple_cauchy_data(densities);
+    std::vector<Eigen::VectorXcd> multiple =
+        disc_pot.evaluateMultiple(points.topRows(100));
+    BEMBEL_TEST_IF(multiple.size() == number_of_densities);
+    for (auto i = 0; i < number_of_densities; ++i) {
+      disc_pot.set_cauchy_data(densities.col(i));
+      Eigen::VectorXcd direct = disc_pot.evaluate(points.topRows(100));
+      BEMBEL_TEST_IF((direct - multiple[i]).norm() / direct.norm() <
+                     Constants::generic_tolerance);
+    }
+    // the adaptive quadrature is honoured as well
+    disc_pot.set_quadrature_tolerance(1e-6);
+    multiple = disc_pot.evaluateMultiple(points.topRows(100));
+    for (auto i = 0; i < number_of_densities; ++i) {
+      disc_pot.set_cauchy_data(densities.col(i));
+      Eigen::VectorXcd direct = disc_pot.evaluate(points.topRows(100));
+      BEMBEL_TEST_IF((direct - multiple[i]).norm() / direct.norm() <
+                     Constants::generic_tolerance);
+    }
+  }
+
+  // several densities at once in a div-conforming space
+  {
+    int number_of_densities = 2;
+    AnsatzSpace<MaxwellSingleLayerOperator> ansatz_space(
+        geometry, refinement_level, polynomial_degree);
+    DiscretePotential<MaxwellSingleLayerPotential<MaxwellSingleLayerOperator>,
+                      MaxwellSingleLayerOperator>
+        disc_pot(ansatz_space);
+    disc_pot.get_potential().set_wavenumber(std::complex<double>(2., 0.));
+    Eigen::MatrixXcd densities = Eigen::MatrixXcd::Random(
+        ansatz_space.get_number_of_dofs(), number_of_densities);
+    disc_pot.set_multiple_cauchy_data(densities);
+    std::vector<Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 3>>
+        multiple = disc_pot.evaluateMultiple(points.topRows(20));
+    for (auto i = 0; i < number_of_densities; ++i) {
+      disc_pot.set_cauchy_data(densities.col(i));
+      Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 3> direct =
+          disc_pot.evaluate(points.topRows(20));
+      BEMBEL_TEST_IF((direct - multiple[i]).norm() / direct.norm() <
+                     Constants::generic_tolerance);
+    }
+  }
+
+  // the double layer potential of a constant density vanishes outside
+  {
+    AnsatzSpace<LaplaceDoubleLayerOperator> ansatz_space(
+        geometry, refinement_level, polynomial_degree);
+    DiscretePotential<LaplaceDoubleLayerPotential<LaplaceDoubleLayerOperator>,
+                      LaplaceDoubleLayerOperator>
+        disc_pot(ansatz_space);
+    disc_pot.set_cauchy_data(
+        Eigen::VectorXd::Ones(ansatz_space.get_number_of_dofs()));
+    disc_pot.set_quadrature_tolerance(1e-8);
+    Eigen::Matrix<double, Eigen::Dynamic, 3> close_points(20, 3);
+    for (auto i = 0; i < close_points.rows(); ++i)
+      close_points.row(i) = (1. + std::pow(10., -3. + .15 * i)) *
+                            Eigen::Vector3d::Random().normalized().transpose();
+    Eigen::VectorXd potential = disc_pot.evaluate(close_points);
+    BEMBEL_TEST_IF(potential.cwiseAbs().maxCoeff() <
+                   Constants::generic_tolerance);
+  }
+
+  return 0;
+}
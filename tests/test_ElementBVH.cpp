@@ -0,0 +1,112 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks the queries of the ElementBVH on the unit sphere and
+ * on a cube against the exact distances and the exact inside test. On the
+ * cube, the closest points of many points lie on the edges and corners of the
+ * elements.
+ */
+
+#include <Bembel/ClusterTree>
+
+#include "tests/Test.hpp"
+
+int main() {
+  using namespace Bembel;
+
+  Geometry geometry("sphere.dat");
+  ClusterTree mesh(geometry, 3);
+  ElementBVH bvh(mesh);
+
+  // every element is contained in exactly one leaf
+  const std::vector<ElementBVHNode> &nodes = bvh.get_nodes();
+  BEMBEL_TEST_IF(bvh.get_root() == nodes.size() - 1);
+  BEMBEL_TEST_IF(std::abs(nodes[bvh.get_root()].area_ - 4 * BEMBEL_PI) <
+                 1e-8);
+  BEMBEL_TEST_IF(nodes[bvh.get_root()].area_normal_.norm() < 1e-8);
+  int number_of_leafs = 0;
+  for (const ElementBVHNode &node : nodes)
+    number_of_leafs += node.sons_.size() == 0;
+  BEMBEL_TEST_IF(number_of_leafs == mesh.get_number_of_elements());
+
+  Eigen::Matrix<double, Eigen::Dynamic, 3> points =
+      1.6 * Eigen::Matrix<double, Eigen::Dynamic, 3>::Random(200, 3);
+  std::vector<const ElementTreeNode *> elements;
+  Eigen::Matrix<double, Eigen::Dynamic, 2> xi;
+  const Eigen::VectorXd distances =
+      bvh.computeDistances(points, &elements, &xi);
+  const Eigen::VectorXi near = bvh.isNearSurface(points, .1);
+  const Eigen::VectorXd winding_numbers = bvh.computeWindingNumbers(points);
+  const Eigen::VectorXi inside = bvh.isInside(points);
+  for (int i = 0; i < points.rows(); ++i) {
+    const double r = points.row(i).norm();
+    BEMBEL_TEST_IF(std::abs(distances(i) - std::abs(r - 1)) < 1e-8);
+    const Eigen::Vector3d closest_point =
+        bvh.get_bezier_element(elements[i]->id_).eval(xi.row(i).transpose());
+    BEMBEL_TEST_IF(std::abs((closest_point - points.row(i).transpose()).norm() -
+                            distances(i)) < 1e-12);
+    if (std::abs(std::abs(r - 1) - .1) > 1e-8)
+      BEMBEL_TEST_IF(near(i) == (std::abs(r - 1) < .1));
+    if (std::abs(r - 1) > .1)
+      BEMBEL_TEST_IF(std::abs(winding_numbers(i) - (r < 1)) < 1e-2);
+    BEMBEL_TEST_IF(inside(i) == (r < 1));
+  }
+  // the mesh is not modified by the hierarchy
+  BEMBEL_TEST_IF(!mesh.has_bezier_elements());
+
+  // the cube [0, .25]^3
+  {
+    Geometry cube("cube_small.dat");
+    ClusterTree cube_mesh(cube, 2);
+    ElementBVH cube_bvh(cube_mesh);
+    const double a = .25;
+    // random points and points close to the edges and corners of the cube
+    Eigen::Matrix<double, Eigen::Dynamic, 3> cube_points(300, 3);
+    cube_points.topRows(100) =
+        (.7 * a * (Eigen::ArrayXXd::Random(100, 3) + 1) - .2 * a).matrix();
+    for (int i = 100; i < 300; ++i) {
+      // a random vertex of the cube and an offset of at most a / 10
+      Eigen::Vector3d vertex = a * (Eigen::Vector3d::Random().array() > 0)
+                                       .cast<double>()
+                                       .matrix();
+      // keep one coordinate free for the points close to the edges
+      if (i >= 200) vertex(i % 3) = Eigen::internal::random<double>(0, a);
+      cube_points.row(i) =
+          (vertex + .1 * a * Eigen::Vector3d::Random()).transpose();
+    }
+    std::vector<const ElementTreeNode *> cube_elements;
+    Eigen::Matrix<double, Eigen::Dynamic, 2> cube_xi;
+    const Eigen::VectorXd cube_distances =
+        cube_bvh.computeDistances(cube_points, &cube_elements, &cube_xi);
+    const Eigen::VectorXi cube_inside = cube_bvh.isInside(cube_points);
+    int number_of_clamped_points = 0;
+    for (int i = 0; i < cube_points.rows(); ++i) {
+      const Eigen::Vector3d p = cube_points.row(i).transpose();
+      const bool is_inside = (p.array() > 0).all() && (p.array() < a).all();
+      const double exact_distance =
+          is_inside ? p.cwiseMin(Eigen::Vector3d::Constant(a) - p).minCoeff()
+                    : (p.cwiseMax(0.).cwiseMin(a) - p).norm();
+      BEMBEL_TEST_IF(std::abs(cube_distances(i) - exact_distance) < 1e-8);
+      const Eigen::Vector3d closest_point =
+          cube_bvh.get_bezier_element(cube_elements[i]->id_)
+              .eval(cube_xi.row(i).transpose());
+      BEMBEL_TEST_IF(std::abs((closest_point - p).norm() - cube_distances(i)) <
+                     1e-12);
+      BEMBEL_TEST_IF(cube_inside(i) == is_inside);
+      number_of_clamped_points += (cube_xi.row(i).array() == 0).any() ||
+                                  (cube_xi.row(i).array() == 1).any();
+    }
+    BEMBEL_TEST_IF(number_of_clamped_points > 50);
+  }
+
+  return 0;
+}
@@ -0,0 +1,105 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks the flat node pool of the ElementTree, i.e., that the
+ * sons are stored after their fathers, that uniform refinement stores the
+ * leafs contiguously in the order of the leaf iterator, and that the
+ * neighbourhood relations are symmetric. Moreover, it checks the points
+ * identified by the parallel refinement.
+ */
+
+#include <Bembel/ClusterTree>
+
+#include "tests/Test.hpp"
+
+bool checkLinks(const Bembel::ElementTree &element_tree) {
+  const std::vector<Bembel::ElementTreeNode> &nodes =
+      element_tree.get_nodes();
+  for (int i = 1; i < nodes.size(); ++i) {
+    const Bembel::ElementTreeNode &node = nodes[i];
+    for (int j = 0; j < node.sons_.size(); ++j)
+      if (node.sons_.first_ + j <= i ||
+          node.sons_[j].level_ != node.level_ + 1 ||
+          node.sons_[j].id_ != 4 * node.id_ + j)
+        return false;
+    // the neighbours of a leaf point back to it
+    if (!node.sons_.size())
+      for (int j = 0; j < 4; ++j) {
+        if (node.adjcents_[j] < 0) continue;
+        const Bembel::ElementTreeNode &neighbour = nodes[node.adjcents_[j]];
+        if (neighbour.level_ != node.level_) continue;
+        if (std::count(neighbour.adjcents_.begin(), neighbour.adjcents_.end(),
+                       i) != 1)
+          return false;
+      }
+  }
+  // the leaf iterator visits every leaf exactly once
+  int number_of_leafs = 0;
+  for (auto it = element_tree.cpbegin(); it != element_tree.cpend(); ++it) {
+    if (it->sons_.size()) return false;
+    ++number_of_leafs;
+  }
+  return number_of_leafs == element_tree.get_number_of_elements();
+}
+
+int main() {
+  using namespace Bembel;
+
+  Geometry geometry("sphere.dat");
+  const int number_of_patches = geometry.get_geometry().size();
+  for (int refinement_level = 0; refinement_level < 5; ++refinement_level) {
+    ElementTree element_tree(geometry, refinement_level);
+    const std::vector<ElementTreeNode> &nodes = element_tree.get_nodes();
+    const int number_of_leafs =
+        number_of_patches * (1 << (2 * refinement_level));
+    BEMBEL_TEST_IF(element_tree.get_number_of_elements() == number_of_leafs);
+    BEMBEL_TEST_IF(nodes.size() ==
+                   1 + number_of_patches *
+                           (((1 << (2 * refinement_level + 2)) - 1) / 3));
+    BEMBEL_TEST_IF(std::addressof(element_tree.root()) == nodes.data());
+    // the pool is ordered by level
+    for (int i = 2; i < nodes.size(); ++i)
+      BEMBEL_TEST_IF(nodes[i - 1].level_ <= nodes[i].level_);
+    // the leafs form the tail of the pool in the order of the leaf iterator
+    const ElementTreeNode *leaf = nodes.data() + nodes.size() - number_of_leafs;
+    for (auto it = element_tree.cpbegin(); it != element_tree.cpend(); ++it)
+      BEMBEL_TEST_IF(std::addressof(*it) == leaf++);
+    BEMBEL_TEST_IF(checkLinks(element_tree));
+    // the sphere is closed, such that Euler's formula yields the number of
+    // points for quadrilateral elements
+    BEMBEL_TEST_IF(element_tree.get_number_of_points() == number_of_leafs + 2);
+    // each point is shared by three or four elements
+    Eigen::VectorXi idct;
+    const Eigen::MatrixXd P = element_tree.generatePointList(&idct);
+    BEMBEL_TEST_IF(idct.minCoeff() >= 3 && idct.maxCoeff() <= 4);
+    for (auto it = element_tree.cpbegin(); it != element_tree.cpend(); ++it)
+      for (int j = 0; j < 4; ++j)
+        BEMBEL_TEST_IF(
+            (P.col(it->vertices_[j]) -
+             geometry.get_geometry()[it->patch_].eval(
+                 it->llc_(0) + Constants::corners[0][j] * it->get_h(),
+                 it->llc_(1) + Constants::corners[1][j] * it->get_h()))
+                .norm() < Test::Constants::test_tolerance_geometry);
+  }
+
+  // non-uniform refinement keeps the links consistent
+  ElementTree element_tree(geometry, 1);
+  element_tree.refinePatch(0);
+  element_tree.refinePatch(number_of_patches - 1);
+  element_tree.refinePatch(0);
+  BEMBEL_TEST_IF(element_tree.get_number_of_elements() ==
+                 number_of_patches * 4 + 12 + 12 + 48);
+  BEMBEL_TEST_IF(element_tree.get_max_level() == 3);
+  BEMBEL_TEST_IF(checkLinks(element_tree));
+
+  return 0;
+}
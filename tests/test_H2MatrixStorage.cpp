@@ -0,0 +1,92 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks that the different storage modes of the H2Matrix
+ * lead to the same matrix-vector multiplication, up to the accuracy of the
+ * storage precision.
+ */
+
+#include <Bembel/AnsatzSpace>
+#include <Bembel/Geometry>
+#include <Bembel/H2Matrix>
+#include <Bembel/Laplace>
+
+#include "tests/Test.hpp"
+
+int main() {
+  using namespace Bembel;
+
+  int polynomial_degree = 1;
+  int refinement_level = 2;
+
+  Geometry geometry("sphere.dat");
+  AnsatzSpace<LaplaceSingleLayerOperator> ansatz_space(
+      geometry, refinement_level, polynomial_degree);
+  LaplaceSingleLayerOperator linOp;
+
+  Eigen::H2Matrix<double> H;
+  H.init_H2Matrix(linOp, ansatz_space);
+  Eigen::VectorXd x = Eigen::VectorXd::Random(H.cols());
+  Eigen::VectorXd y = H * x;
+
+  // dense leaves which are integrated on the fly
+  {
+    Eigen::H2Matrix<double> H_otf;
+    H_otf.set_nearfield_mode(H2NearfieldMode::OnTheFly);
+    H_otf.init_H2Matrix(linOp, ansatz_space);
+    BEMBEL_TEST_IF(H_otf.get_memory_footprint().dense_leaves_ == 0);
+    Eigen::VectorXd y_otf = H_otf * x;
+    BEMBEL_TEST_IF((y - y_otf).norm() / y.norm() <
+                   Constants::generic_tolerance);
+  }
+
+  // dense leaves which are moved into contiguous memory
+  {
+    Eigen::H2Matrix<double> H_packed;
+    H_packed.set_nearfield_mode(H2NearfieldMode::Packed);
+    H_packed.init_H2Matrix(linOp, ansatz_space);
+    BEMBEL_TEST_IF(H_packed.get_memory_footprint().dense_leaves_ ==
+                   H.get_memory_footprint().dense_leaves_);
+    int number_of_dense_leaves = 0;
+    for (auto n : H.get_memory_footprint().number_of_dense_leaves_per_depth_)
+      number_of_dense_leaves += n;
+    BEMBEL_TEST_IF(
+        H_packed.get_packed_nearfield()(0, 0).get_number_of_blocks() ==
+        number_of_dense_leaves);
+    Eigen::VectorXd y_packed = H_packed * x;
+    BEMBEL_TEST_IF((y - y_packed).norm() / y.norm() <
+                   Constants::generic_tolerance);
+  }
+
+  // leaves and moment matrices in single precision
+  for (auto precision : {H2StoragePrecision::Single,
+                         H2StoragePrecision::SingleWithMoments}) {
+    Eigen::H2Matrix<double> H_single;
+    H_single.set_storage_precision(precision);
+    H_single.init_H2Matrix(linOp, ansatz_space);
+    H2MemoryFootprint footprint = H_single.get_memory_footprint();
+    BEMBEL_TEST_IF(2 * footprint.dense_leaves_ ==
+                   H.get_memory_footprint().dense_leaves_);
+    BEMBEL_TEST_IF(2 * footprint.low_rank_leaves_ ==
+                   H.get_memory_footprint().low_rank_leaves_);
+    // the moment matrices are kept in one precision only
+    const bool single_moments =
+        precision == H2StoragePrecision::SingleWithMoments;
+    BEMBEL_TEST_IF(H_single.get_fmm_moment_matrix().empty() == single_moments);
+    BEMBEL_TEST_IF(H_single.get_fmm_moment_matrix_single().empty() !=
+                   single_moments);
+    Eigen::VectorXd y_single = H_single * x;
+    BEMBEL_TEST_IF((y - y_single).norm() / y.norm() < 1e-5);
+  }
+
+  return 0;
+}
@@ -0,0 +1,68 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks that the predicted memory footprint of an H2Matrix
+ * coincides with the one of the assembled matrix and that a memory budget is
+ * respected by the assembly.
+ */
+
+#include <Bembel/AnsatzSpace>
+#include <Bembel/Geometry>
+#include <Bembel/H2Matrix>
+#include <Bembel/Laplace>
+
+#include "tests/Test.hpp"
+
+int main() {
+  using namespace Bembel;
+
+  int polynomial_degree = 1;
+  int refinement_level = 2;
+  int number_of_points = 9;
+
+  Geometry geometry("sphere.dat");
+  AnsatzSpace<LaplaceSingleLayerOperator> ansatz_space(
+      geometry, refinement_level, polynomial_degree);
+  LaplaceSingleLayerOperator linOp;
+
+  std::size_t unconstrained = 0;
+  {
+    Eigen::H2Matrix<double> H;
+    H.init_H2Matrix(linOp, ansatz_space, number_of_points);
+    H2MemoryFootprint footprint = H.get_memory_footprint();
+    H2MemoryFootprint estimate = estimateH2MemoryFootprint(
+        H.get_block_cluster_tree()(0, 0), 1,
+        LinearOperatorTraits<LaplaceSingleLayerOperator>::NumberOfFMMComponents,
+        number_of_points, ansatz_space.get_transformation_matrix());
+    BEMBEL_TEST_IF(footprint.dense_leaves_ == estimate.dense_leaves_);
+    BEMBEL_TEST_IF(footprint.low_rank_leaves_ == estimate.low_rank_leaves_);
+    BEMBEL_TEST_IF(footprint.moment_matrices_ == estimate.moment_matrices_);
+    BEMBEL_TEST_IF(footprint.transfer_matrices_ ==
+                   estimate.transfer_matrices_);
+    BEMBEL_TEST_IF(footprint.total() == estimate.total());
+    BEMBEL_TEST_IF(footprint.dense_leaves_per_depth_ ==
+                   estimate.dense_leaves_per_depth_);
+    BEMBEL_TEST_IF(footprint.low_rank_leaves_per_depth_ ==
+                   estimate.low_rank_leaves_per_depth_);
+    unconstrained = footprint.total();
+  }
+
+  // a budget below the default footprint enforces a different tree
+  {
+    Eigen::H2Matrix<double> H;
+    H.set_memory_budget(unconstrained * 3 / 4);
+    H.init_H2Matrix(linOp, ansatz_space, number_of_points);
+    BEMBEL_TEST_IF(H.get_memory_footprint().total() <= unconstrained * 3 / 4);
+  }
+
+  return 0;
+}
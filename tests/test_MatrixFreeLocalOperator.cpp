@@ -0,0 +1,96 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks that the matrix-free application of local operators
+ * coincides with the product with the assembled sparse matrix and that it can
+ * be used with the iterative solvers of Eigen.
+ */
+
+#include <Bembel/Identity>
+#include <Bembel/LaplaceBeltrami>
+#include <Eigen/IterativeLinearSolvers>
+
+#include "tests/Test.hpp"
+
+template <typename Derived>
+bool checkProduct(const Bembel::Geometry &geometry, int refinement_level,
+                  int polynomial_degree) {
+  Bembel::AnsatzSpace<Derived> ansatz_space(geometry, refinement_level,
+                                            polynomial_degree);
+  Bembel::DiscreteLocalOperator<Derived> disc_op(ansatz_space);
+  disc_op.compute();
+  Bembel::MatrixFreeDiscreteLocalOperator<Derived> matrix_free_op(
+      ansatz_space);
+  matrix_free_op.compute();
+  const auto &matrix = disc_op.get_discrete_operator();
+  const auto &matrix_free = matrix_free_op.get_discrete_operator();
+  if (matrix_free.rows() != matrix.rows() ||
+      matrix_free.cols() != matrix.cols())
+    return false;
+  const Eigen::MatrixXd x = Eigen::MatrixXd::Random(matrix.cols(), 2);
+  const Eigen::MatrixXd y = matrix * x;
+  const Eigen::MatrixXd y_matrix_free = matrix_free * x;
+  const Eigen::VectorXd z = matrix * x.col(0);
+  const Eigen::VectorXd z_matrix_free = matrix_free * x.col(0);
+  // the parallel product with the transposed transformation matrix, which
+  // replaces the structured transformation if the latter is not exact
+  const Eigen::VectorXd v =
+      Eigen::VectorXd::Random(matrix_free.get_transformation_matrix().rows());
+  const Eigen::VectorXd w =
+      matrix_free.get_transformation_matrix().transpose() * v;
+  Eigen::VectorXd w_parallel;
+  matrix_free.applyTransposedTransformation(v, &w_parallel);
+  return (y - y_matrix_free).norm() <
+             Test::Constants::test_tolerance_geometry * y.norm() &&
+         (z - z_matrix_free).norm() <
+             Test::Constants::test_tolerance_geometry * z.norm() &&
+         (w - w_parallel).norm() <
+             Test::Constants::test_tolerance_geometry * w.norm();
+}
+
+int main() {
+  using namespace Bembel;
+
+  Geometry geometry("sphere.dat");
+  for (int refinement_level = 0; refinement_level < 3; ++refinement_level)
+    for (int polynomial_degree = 0; polynomial_degree < 3;
+         ++polynomial_degree) {
+      BEMBEL_TEST_IF(checkProduct<MassMatrixScalarDisc>(
+          geometry, refinement_level, polynomial_degree));
+      BEMBEL_TEST_IF(checkProduct<MassMatrixScalarCont>(
+          geometry, refinement_level, polynomial_degree + 1));
+      BEMBEL_TEST_IF(checkProduct<LaplaceBeltramiOperator>(
+          geometry, refinement_level, polynomial_degree + 1));
+    }
+
+  // solve a mass matrix system with the conjugate gradient method
+  AnsatzSpace<MassMatrixScalarCont> ansatz_space(geometry, 2, 2);
+  DiscreteLocalOperator<MassMatrixScalarCont> disc_op(ansatz_space);
+  disc_op.compute();
+  MatrixFreeDiscreteLocalOperator<MassMatrixScalarCont> matrix_free_op(
+      ansatz_space);
+  matrix_free_op.compute();
+  const Eigen::VectorXd rhs =
+      Eigen::VectorXd::Ones(disc_op.get_discrete_operator().cols());
+  Eigen::ConjugateGradient<Eigen::MatrixFreeLocalOperator<double>,
+                           Eigen::Lower | Eigen::Upper,
+                           Eigen::IdentityPreconditioner>
+      cg;
+  cg.setTolerance(1e-12);
+  cg.compute(matrix_free_op.get_discrete_operator());
+  const Eigen::VectorXd x = cg.solve(rhs);
+  BEMBEL_TEST_IF(cg.info() == Eigen::Success);
+  BEMBEL_TEST_IF((disc_op.get_discrete_operator() * x - rhs).norm() <
+                 1e-10 * rhs.norm());
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks that the batched evaluation of a patch coincides with
+ * the evaluation point by point, also if the points are spread over several
+ * Bezier elements of a patch with interior knots.
+ */
+
+#include <Bembel/Geometry>
+#include <Bembel/Quadrature>
+
+#include "tests/Test.hpp"
+
+int main() {
+  using namespace Bembel;
+
+  Geometry geometry("sphere.dat");
+  GaussSquare<5> GS;
+  const auto &Q = GS[4];
+  const int number_of_points = Q.w_.size();
+
+  for (const auto &patch : geometry.get_geometry()) {
+    // evaluate on the elements of a uniform refinement of level 2
+    for (int ex = 0; ex < 4; ++ex) {
+      for (int ey = 0; ey < 4; ++ey) {
+        const double h = .25;
+        Eigen::Matrix<double, 2, Eigen::Dynamic> ref_pts = h * Q.xi_;
+        ref_pts.colwise() += Eigen::Vector2d(ex * h, ey * h);
+
+        Eigen::Matrix<double, Eigen::Dynamic, 3> points;
+        Eigen::Matrix<double, Eigen::Dynamic, 6> jacobians;
+        patch.evalBatch(ref_pts, &points, &jacobians);
+        ElementSurfacePoints srf_pts;
+        patch.updateSurfacePoints(&srf_pts, ref_pts, Q.w_, Q.xi_);
+        BEMBEL_TEST_IF(srf_pts.size() == number_of_points);
+
+        for (int k = 0; k < number_of_points; ++k) {
+          const Eigen::Vector2d pt = ref_pts.col(k);
+          const Eigen::Matrix<double, 3, 2> jacobian = patch.evalJacobian(pt);
+          BEMBEL_TEST_IF((points.row(k).transpose() - patch.eval(pt)).norm() <
+                         Test::Constants::test_tolerance_geometry);
+          BEMBEL_TEST_IF((jacobians.row(k).head<3>().transpose() -
+                          jacobian.col(0))
+                             .norm() < Test::Constants::test_tolerance_geometry);
+          BEMBEL_TEST_IF((jacobians.row(k).tail<3>().transpose() -
+                          jacobian.col(1))
+                             .norm() < Test::Constants::test_tolerance_geometry);
+
+          SurfacePoint srf_pt;
+          patch.updateSurfacePoint(&srf_pt, pt, Q.w_(k), Q.xi_.col(k));
+          BEMBEL_TEST_IF((srf_pts[k] - srf_pt).norm() <
+                         Test::Constants::test_tolerance_geometry);
+        }
+      }
+    }
+  }
+
+  // rational patch of degree two with non-dyadic interior knots, such that
+  // the elements of a uniform refinement are cut by the knots
+  {
+    std::vector<double> knots_x = {0, 0, 0, .3, .7, 1, 1, 1};
+    std::vector<double> knots_y = {0, 0, 0, .4, 1, 1, 1};
+    std::vector<Eigen::MatrixXd> xyzw(4, Eigen::MatrixXd(4, 5));
+    for (int i = 0; i < 4; ++i)
+      for (int j = 0; j < 5; ++j) {
+        xyzw[0](i, j) = j;
+        xyzw[1](i, j) = i;
+        xyzw[2](i, j) = std::sin(i + 2. * j);
+        xyzw[3](i, j) = 1. + .1 * ((i + j) % 3);
+      }
+    for (int k = 0; k < 3; ++k) xyzw[k] = xyzw[k].cwiseProduct(xyzw[3]);
+    Patch patch(xyzw, knots_x, knots_y);
+    for (int ex = 0; ex < 4; ++ex) {
+      for (int ey = 0; ey < 4; ++ey) {
+        const double h = .25;
+        Eigen::Matrix<double, 2, Eigen::Dynamic> ref_pts = h * Q.xi_;
+        ref_pts.colwise() += Eigen::Vector2d(ex * h, ey * h);
+
+        Eigen::Matrix<double, Eigen::Dynamic, 3> points;
+        Eigen::Matrix<double, Eigen::Dynamic, 6> jacobians;
+        patch.evalBatch(ref_pts, &points, &jacobians);
+        for (int k = 0; k < number_of_points; ++k) {
+          const Eigen::Vector2d pt = ref_pts.col(k);
+          const Eigen::Matrix<double, 3, 2> jacobian = patch.evalJacobian(pt);
+          BEMBEL_TEST_IF((points.row(k).transpose() - patch.eval(pt)).norm() <
+                         Test::Constants::test_tolerance_geometry);
+          BEMBEL_TEST_IF((jacobians.row(k).head<3>().transpose() -
+                          jacobian.col(0))
+                             .norm() < Test::Constants::test_tolerance_geometry);
+          BEMBEL_TEST_IF((jacobians.row(k).tail<3>().transpose() -
+                          jacobian.col(1))
+                             .norm() < Test::Constants::test_tolerance_geometry);
+        }
+      }
+    }
+  }
+
+  return 0;
+}
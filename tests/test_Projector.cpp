@@ -130,5 +130,17 @@ int main() {
                        Test::Constants::coefficient_accuracy);
       }
 
+  // The univariate local projections are computed once and shared, also when
+  // they are requested concurrently
+  const int number_of_requests = 16;
+  std::vector<std::shared_ptr<const ProjectorRoutines::_local_projection_1d>>
+      projections(number_of_requests);
+#pragma omp parallel for
+  for (int i = 0; i < number_of_requests; ++i)
+    projections[i] = ProjectorRoutines::getLocalProjection1D(4, 4, 1, 5);
+  for (int i = 0; i < number_of_requests; ++i)
+    BEMBEL_TEST_IF(projections[i] == projections[0]);
+  BEMBEL_TEST_IF(projections[0]->dim == 3 + (1 << 5));
+
   return 0;
 }
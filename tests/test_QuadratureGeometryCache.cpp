@@ -0,0 +1,137 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks that the surface points of a cubature rule are
+ * computed once per mesh, are shared by copies of the ansatz space and by
+ * concurrent requests, and coincide with the ones obtained by
+ * SuperSpace::map2surface, with and without BezierElements. Moreover, it
+ * checks that the data of a mesh is recomputed after a refinement.
+ */
+
+#include <Bembel/AnsatzSpace>
+#include <Bembel/Geometry>
+#include <Bembel/Laplace>
+#include <Bembel/Quadrature>
+
+#include "tests/Test.hpp"
+
+int main() {
+  using namespace Bembel;
+
+  int polynomial_degree = 1;
+  int refinement_level = 2;
+
+  Geometry geometry("sphere.dat");
+  AnsatzSpace<LaplaceSingleLayerOperator> ansatz_space(
+      geometry, refinement_level, polynomial_degree);
+  const SuperSpace<LaplaceSingleLayerOperator> &super_space =
+      ansatz_space.get_superspace();
+  const ClusterTree &mesh = super_space.get_mesh();
+  GaussSquare<Constants::maximum_quadrature_degree> GS;
+
+  auto qps = mesh.get_quadrature_points(GS[3]);
+  BEMBEL_TEST_IF(mesh.get_quadrature_cache().get_number_of_rules() == 1);
+  BEMBEL_TEST_IF(qps->size() == mesh.get_number_of_elements());
+
+  // the same rule is not evaluated again, neither by copies of the space
+  AnsatzSpace<LaplaceSingleLayerOperator> copy = ansatz_space;
+  BEMBEL_TEST_IF(mesh.get_quadrature_points(GS[3]) == qps);
+  BEMBEL_TEST_IF(copy.get_superspace().get_mesh().get_quadrature_points(
+                     GS[3]) == qps);
+  BEMBEL_TEST_IF(mesh.get_quadrature_points(GS[4]) != qps);
+  BEMBEL_TEST_IF(mesh.get_quadrature_cache().get_number_of_rules() == 2);
+
+  // the cached points coincide with the mapped quadrature points
+  const ElementTree &element_tree = mesh.get_element_tree();
+  for (auto element = element_tree.cpbegin(); element != element_tree.cpend();
+       ++element)
+    for (auto k = 0; k < GS[3].w_.size(); ++k) {
+      SurfacePoint qp;
+      super_space.map2surface(*element, GS[3].xi_.col(k),
+                              element->get_h() * GS[3].w_(k), &qp);
+      BEMBEL_TEST_IF(((*qps)[element->id_][k] - qp).norm() <
+                     Constants::generic_tolerance);
+    }
+
+  // released points stay valid for their users
+  mesh.get_quadrature_cache().clear();
+  BEMBEL_TEST_IF(mesh.get_quadrature_cache().get_number_of_rules() == 0);
+  BEMBEL_TEST_IF(qps->size() == mesh.get_number_of_elements());
+
+  // concurrent requests of the same rules obtain the same points
+  std::vector<std::shared_ptr<const std::vector<ElementSurfacePoints>>>
+      requests(16);
+#pragma omp parallel for
+  for (auto i = 0; i < static_cast<int>(requests.size()); ++i)
+    requests[i] = mesh.get_quadrature_points(GS[2 + i % 2]);
+  BEMBEL_TEST_IF(mesh.get_quadrature_cache().get_number_of_rules() == 2);
+  for (auto i = 2; i < static_cast<int>(requests.size()); ++i)
+    BEMBEL_TEST_IF(requests[i] == requests[i % 2]);
+
+  // the BezierElements replace the stored points, as for map2surface
+  {
+    AnsatzSpace<LaplaceSingleLayerOperator> bezier_space(
+        geometry, refinement_level, polynomial_degree, 1, true);
+    const SuperSpace<LaplaceSingleLayerOperator> &bezier_super_space =
+        bezier_space.get_superspace();
+    const ClusterTree &bezier_mesh = bezier_super_space.get_mesh();
+    const ElementTree &bezier_tree = bezier_mesh.get_element_tree();
+    BEMBEL_TEST_IF(bezier_mesh.has_bezier_elements());
+    auto bezier_qps = bezier_mesh.get_quadrature_points(GS[3]);
+    for (auto element = bezier_tree.cpbegin(); element != bezier_tree.cpend();
+         ++element)
+      for (auto k = 0; k < GS[3].w_.size(); ++k) {
+        SurfacePoint qp;
+        bezier_super_space.map2surface(*element, GS[3].xi_.col(k),
+                                       element->get_h() * GS[3].w_(k), &qp);
+        BEMBEL_TEST_IF(((*bezier_qps)[element->id_][k] - qp).norm() <
+                       Constants::generic_tolerance);
+      }
+  }
+
+  // initializing the BezierElements releases the stored points
+  {
+    ClusterTree bezier_mesh(geometry, refinement_level);
+    bezier_mesh.get_quadrature_points(GS[3]);
+    bezier_mesh.init_BezierElements();
+    BEMBEL_TEST_IF(bezier_mesh.get_quadrature_cache().get_number_of_rules() ==
+                   0);
+  }
+
+  // the data depending on the elements is recomputed after a refinement
+  {
+    ClusterTree refined_mesh(geometry, 1, true);
+    refined_mesh.get_quadrature_points(GS[3]);
+    refined_mesh.get_element_tree().refineUniformly();
+    refined_mesh.updateAfterRefinement();
+    const int number_of_elements = refined_mesh.get_number_of_elements();
+    BEMBEL_TEST_IF(refined_mesh.get_quadrature_cache().get_number_of_rules() ==
+                   0);
+    auto refined_qps = refined_mesh.get_quadrature_points(GS[3]);
+    BEMBEL_TEST_IF(refined_qps->size() == number_of_elements);
+    const ElementTree &refined_tree = refined_mesh.get_element_tree();
+    BEMBEL_TEST_IF(refined_mesh.get_points().cols() ==
+                   refined_tree.get_number_of_points());
+    for (auto element = refined_tree.cpbegin();
+         element != refined_tree.cpend(); ++element) {
+      BEMBEL_TEST_IF(std::isfinite(element->radius_));
+      const Eigen::Vector2d midpoint =
+          element->llc_ + .5 * element->get_h() * Eigen::Vector2d::Ones();
+      BEMBEL_TEST_IF((refined_mesh.get_bezier_element(element->id_)
+                          .eval(Eigen::Vector2d(.5, .5)) -
+                      geometry.get_geometry()[element->patch_].eval(midpoint))
+                         .norm() < Test::Constants::test_tolerance_geometry);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,46 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks that the quadrature rules of the registry are created
+ * once, also when requested concurrently, and coincide with the rules
+ * constructed directly.
+ */
+
+#include <Bembel/Quadrature>
+
+#include "tests/Test.hpp"
+
+int main() {
+  using namespace Bembel;
+
+  constexpr unsigned int max_order = 20;
+  const int number_of_requests = 16;
+  std::vector<const GaussSquare<max_order> *> rules(number_of_requests);
+#pragma omp parallel for
+  for (int i = 0; i < number_of_requests; ++i)
+    rules[i] = &getGaussSquare<max_order>();
+  for (int i = 0; i < number_of_requests; ++i)
+    BEMBEL_TEST_IF(rules[i] == rules[0]);
+
+  GaussSquare<max_order> GS;
+  GaussLegendre<max_order> GL;
+  const GaussSquare<max_order> &shared_GS = getGaussSquare<max_order>();
+  const GaussLegendre<max_order> &shared_GL = getGaussLegendre<max_order>();
+  for (int i = 0; i <= max_order; ++i) {
+    BEMBEL_TEST_IF((shared_GS[i].xi_ - GS[i].xi_).norm() == 0);
+    BEMBEL_TEST_IF((shared_GS[i].w_ - GS[i].w_).norm() == 0);
+    BEMBEL_TEST_IF((shared_GL[i].xi_ - GL[i].xi_).norm() == 0);
+    BEMBEL_TEST_IF((shared_GL[i].w_ - GL[i].w_).norm() == 0);
+  }
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks that the structured representation of the
+ * transformation matrix coincides with the sparse matrix.
+ */
+
+#include <Bembel/AnsatzSpace>
+#include <Bembel/Identity>
+#include <Bembel/Laplace>
+#include <Bembel/Maxwell>
+
+#include "tests/Test.hpp"
+
+template <typename Derived>
+bool checkTransformation(const Bembel::Geometry &geometry, int refinement_level,
+                         int polynomial_degree, int knot_repetition) {
+  Bembel::AnsatzSpace<Derived> ansatz_space(geometry, refinement_level,
+                                            polynomial_degree, knot_repetition);
+  const Eigen::SparseMatrix<double> &matrix =
+      ansatz_space.get_transformation_matrix();
+  const Bembel::StructuredTransformation &structured =
+      ansatz_space.get_structured_transformation();
+  if (!structured.is_exact()) return true;
+  if (structured.rows() != matrix.rows() || structured.cols() != matrix.cols())
+    return false;
+
+  typedef typename Bembel::LinearOperatorTraits<Derived>::Scalar Scalar;
+  const Eigen::Matrix<Scalar, Eigen::Dynamic, 1> x =
+      Eigen::Matrix<Scalar, Eigen::Dynamic, 1>::Random(matrix.cols());
+  const Eigen::Matrix<Scalar, Eigen::Dynamic, 1> y =
+      Eigen::Matrix<Scalar, Eigen::Dynamic, 1>::Random(matrix.rows());
+  Eigen::Matrix<Scalar, Eigen::Dynamic, 1> Tx;
+  Eigen::Matrix<Scalar, Eigen::Dynamic, 1> Tty;
+  structured.apply(x, &Tx);
+  structured.applyTranspose(y, &Tty);
+  const Eigen::Matrix<Scalar, Eigen::Dynamic, 1> Tx_ref = matrix * x;
+  const Eigen::Matrix<Scalar, Eigen::Dynamic, 1> Tty_ref =
+      matrix.transpose() * y;
+  if ((Tx - Tx_ref).norm() >
+          Test::Constants::test_tolerance_geometry * Tx_ref.norm() ||
+      (Tty - Tty_ref).norm() >
+          Test::Constants::test_tolerance_geometry * Tty_ref.norm())
+    return false;
+
+  // the Galerkin projection of a dense matrix
+  if (matrix.rows() < 1000) {
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> A =
+        Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Random(
+            matrix.rows(), matrix.rows());
+    const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> A_ref =
+        matrix.transpose() * (A * matrix);
+    structured.projectDense(&A);
+    if ((A - A_ref).norm() >
+        Test::Constants::test_tolerance_geometry * A_ref.norm())
+      return false;
+  }
+  return true;
+}
+
+int main() {
+  using namespace Bembel;
+
+  Geometry geometry("sphere.dat");
+  for (int refinement_level = 0; refinement_level < 4; ++refinement_level)
+    for (int polynomial_degree = 1; polynomial_degree < 5;
+         ++polynomial_degree) {
+      BEMBEL_TEST_IF(checkTransformation<MassMatrixScalarDisc>(
+          geometry, refinement_level, polynomial_degree - 1, 1));
+      BEMBEL_TEST_IF(checkTransformation<LaplaceSingleLayerOperator>(
+          geometry, refinement_level, polynomial_degree, 1));
+      BEMBEL_TEST_IF(checkTransformation<LaplaceHypersingularOperator>(
+          geometry, refinement_level, polynomial_degree, 1));
+      BEMBEL_TEST_IF(checkTransformation<MaxwellSingleLayerOperator>(
+          geometry, refinement_level, polynomial_degree, 1));
+      BEMBEL_TEST_IF(checkTransformation<LaplaceHypersingularOperator>(
+          geometry, refinement_level, polynomial_degree, polynomial_degree));
+    }
+
+  // up to polynomial degree four, the structured representation is exact
+  for (int polynomial_degree = 1; polynomial_degree < 5; ++polynomial_degree) {
+    AnsatzSpace<LaplaceHypersingularOperator> ansatz_space(geometry, 3,
+                                                           polynomial_degree);
+    BEMBEL_TEST_IF(ansatz_space.get_structured_transformation().is_exact());
+  }
+
+  return 0;
+}
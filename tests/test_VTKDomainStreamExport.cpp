@@ -0,0 +1,75 @@
+// This file is part of Bembel, the higher order C++ boundary element library.
+//
+// Copyright (C) 2024 see <http://www.bembel.eu>
+//
+// It was written as part of a cooperation of J. Doelz, H. Harbrecht, S. Kurz,
+// M. Multerer, S. Schoeps, and F. Wolf at Technische Universitaet Darmstadt,
+// Universitaet Basel, and Universita della Svizzera italiana, Lugano. This
+// source code is subject to the GNU General Public License version 3 and
+// provided WITHOUT ANY WARRANTY, see <http://www.bembel.eu> for further
+// information.
+
+/**
+ * This unit test checks that the VTKDomainStreamExport writes the values of
+ * the data sets in the order of the grid, independently of the chunking.
+ */
+
+#include <Bembel/IO>
+
+#include "tests/Test.hpp"
+
+int main() {
+  using namespace Bembel;
+
+  Eigen::VectorXd x_vec = Eigen::VectorXd::LinSpaced(7, 0, 1);
+  Eigen::VectorXd y_vec = Eigen::VectorXd::LinSpaced(5, -1, 1);
+  Eigen::VectorXd z_vec = Eigen::VectorXd::LinSpaced(3, 1, 2);
+  const int number_of_points = x_vec.size() * y_vec.size() * z_vec.size();
+
+  VTKDomainStreamExport writer(x_vec, y_vec, z_vec);
+  writer.set_chunk_size(10);
+  writer.addDataSet(
+      "scalar", 1, [](const Eigen::Matrix<double, Eigen::Dynamic, 3> &points) {
+        return Eigen::MatrixXd(points * Eigen::Vector3d(1., 2., 3.));
+      });
+  writer.addDataSet(
+      "vector", 3, [](const Eigen::Matrix<double, Eigen::Dynamic, 3> &points) {
+        return Eigen::MatrixXd(points);
+      });
+
+  for (auto overlap : {false, true}) {
+    writer.set_overlap(overlap);
+    writer.writeRawToFile("test_VTKDomainStreamExport.raw");
+    std::vector<float> data(4 * number_of_points);
+    std::ifstream input("test_VTKDomainStreamExport.raw", std::ios::binary);
+    input.read(reinterpret_cast<char *>(data.data()),
+               data.size() * sizeof(float));
+    BEMBEL_TEST_IF(input.gcount() == data.size() * sizeof(float));
+    BEMBEL_TEST_IF(input.peek() == EOF);
+    for (auto k = 0; k < z_vec.size(); ++k)
+      for (auto j = 0; j < y_vec.size(); ++j)
+        for (auto i = 0; i < x_vec.size(); ++i) {
+          const int index = i + x_vec.size() * (j + y_vec.size() * k);
+          Eigen::Vector3d point(x_vec(i), y_vec(j), z_vec(k));
+          BEMBEL_TEST_IF(std::abs(data[index] - (point(0) + 2. * point(1) +
+                                                 3. * point(2))) < 1e-5);
+          for (auto d = 0; d < 3; ++d)
+            BEMBEL_TEST_IF(std::abs(data[number_of_points + 3 * index + d] -
+                                    point(d)) < 1e-5);
+        }
+  }
+
+  writer.writeToFile("test_VTKDomainStreamExport.vts");
+  std::ifstream vts("test_VTKDomainStreamExport.vts", std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(vts)),
+                      std::istreambuf_iterator<char>());
+  BEMBEL_TEST_IF(content.find("Name=\"vector\"") != std::string::npos);
+  // appended data: three arrays with a header each
+  const std::string marker = "<AppendedData encoding=\"raw\">\n_";
+  std::size_t begin = content.find(marker) + marker.size();
+  std::size_t end = content.rfind("\n</AppendedData>");
+  BEMBEL_TEST_IF(end - begin ==
+                 3 * sizeof(std::uint64_t) + 7 * number_of_points * 4);
+
+  return 0;
+}
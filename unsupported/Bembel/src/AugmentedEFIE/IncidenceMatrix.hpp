@@ -56,8 +56,7 @@ class IncidenceMatrix {
     const auto &element_tree = super_space.get_mesh().get_element_tree();
 
     // Quadrature
-    GaussSquare<20> GS;
-    Cubature Q = GS[19];
+    const Cubature &Q = getGaussSquare<20>()[19];
     const auto &number_of_elements = element_tree.get_number_of_elements();
     const auto polynomial_degree_plus_one_squared_vec =
         super_space_vec.get_polynomial_degree_plus_one_squared();